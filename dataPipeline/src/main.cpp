@@ -4,20 +4,54 @@
 #include <chrono>
 #include <sstream>
 #include <stdexcept>
-#include <iomanip>
 #include <filesystem>
+#include <memory>
+#include <limits>
+#include <cstdio>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
 // Database library
 #include <SQLiteCpp/SQLiteCpp.h>
 
-// Parquet/Arrow libraries
-#include <arrow/api.h>
-#include <arrow/io/api.h>
-#include <parquet/arrow/writer.h>
-#include <arrow/util/logging.h>
+#include "parquet_tick_writer.h"
+#include "partitioned_tick_writer.h"
+#include "manifest.h"
+#include "roll_map.h"
+#include "tick_cache_writer.h"
+#include "timestamps.h"
+
+// Command line options shared by every table.
+struct CleanerOptions {
+    ParquetWriterOptions parquet;
+    int jobs = 1;              // tables converted concurrently
+    int table_jobs = 1;        // reader threads per table, each on its own id range
+    bool roll_map = false;     // write one continuous contract instead of one output per table
+    bool partitioned = false;  // write <table>/year=/month=/day=/ datasets instead of <table>.parquet
+    int session_start_minutes = 0;   // New York time a day partition starts at, minutes past midnight
+    bool incremental = false;  // continue partitioned datasets after their manifest watermarks
+    std::vector<std::string> tables;   // only these tables, in this order (default: every table)
+    bool tick_cache = false;   // also write <table>.ticks for footprint_trainer
+    double tick_size = 0.25;   // price of one tick, used to store tick cache (and --compact) prices as integer ticks
+};
+
+// Outcome of one table, collected from the workers and reported once every table is done.
+struct TableResult {
+    std::string table_name;
+    int64_t rows = 0;
+    std::string error;   // empty if the table was converted (or had no data)
+};
+
+// Tables may be converted on several threads, whole lines are written under this lock so they don't interleave.
+std::mutex output_mutex;
 
-// Timezone library
-#include "date/tz.h"
+void log_line(std::ostream& stream, const std::string& line) {
+    std::lock_guard<std::mutex> lock(output_mutex);
+    stream << line << std::endl;
+}
 
 // Holds the final, clean data for a single tick.
 struct ProcessedTick {
@@ -28,119 +62,458 @@ struct ProcessedTick {
     int64_t bidVolume;
 };
 
-// Writes the buffer for a full table to a single Parquet file.
-void write_table_to_parquet(
-    const std::vector<ProcessedTick>& buffer,
-    const std::string& output_path)
+// Columns every tick query selects, converted by convert_row.
+const std::string TICK_COLUMNS = "SELECT id, \"Date\", \"Time\", \"Close\", \"AskVolume\", \"BidVolume\" FROM \"";
+
+// Converts the current row of a tick query. Returns false (after a warning) if its timestamp doesn't parse.
+bool convert_row(SQLite::Statement& query, NewYorkClock& ny_clock, ProcessedTick& tick) {
+    // Columns by position, in the order of TICK_COLUMNS
+    const char* date_text = query.getColumn(1).getText();
+    const char* time_text = query.getColumn(2).getText();
+
+    int64_t utc_ns;
+    if (!parse_utc_timestamp(date_text, time_text, utc_ns)) {
+        log_line(std::cerr, std::string("Warning: Failed to parse timestamp: ") + date_text + " " + time_text);
+        return false;
+    }
+
+    tick.id = query.getColumn(0).getInt64();
+    // Store a time_point representing the local New York time
+    tick.dateTime = std::chrono::system_clock::time_point(std::chrono::nanoseconds(ny_clock.to_local_ns(utc_ns)));
+    tick.price = query.getColumn(3).getDouble();
+    tick.askVolume = query.getColumn(4).getInt64();
+    tick.bidVolume = query.getColumn(5).getInt64();
+    return true;
+}
+
+// The output files of one table, or of the continuous contract in roll map mode.
+// Either <name>.parquet or, if dataset_root is given, a day partitioned dataset there, plus <name>.ticks
+// with --tick-cache. The files are opened on the first tick so empty tables leave no files behind.
+class TableOutput {
+public:
+    // previous is the manifest of the dataset being continued with --incremental
+    TableOutput(const std::string& name, const std::string& output_dir, const CleanerOptions& options,
+                const std::string& dataset_root = "", const DatasetManifest& previous = DatasetManifest())
+        : output_dir(output_dir),
+          parquet_path(!dataset_root.empty() ? dataset_root : (std::filesystem::path(output_dir) / (name + ".parquet")).string()),
+          cache_path((std::filesystem::path(output_dir) / (name + ".ticks")).string()),
+          options(options),
+          partitioned(!dataset_root.empty()),
+          previous(previous) {}
+
+    void append(const ProcessedTick& tick) {
+        if (!parquet_writer && !partitioned_writer) {
+            std::filesystem::create_directories(output_dir);
+            log_line(std::cout, "Writing ticks to " + parquet_path + "...");
+            if (partitioned) {
+                partitioned_writer = std::make_unique<PartitionedTickWriter>(parquet_path, options.parquet, options.session_start_minutes, previous);
+            } else {
+                parquet_writer = std::make_unique<ParquetTickWriter>(parquet_path, options.parquet);
+            }
+            if (options.tick_cache) {
+                cache_writer = std::make_unique<TickCacheWriter>(cache_path, options.tick_size);
+            }
+        }
+
+        const int64_t time_ns = tick.dateTime.time_since_epoch().count();
+        if (partitioned_writer) {
+            partitioned_writer->append(tick.id, time_ns, tick.price, tick.askVolume, tick.bidVolume);
+        } else {
+            parquet_writer->append(tick.id, time_ns, tick.price, tick.askVolume, tick.bidVolume);
+        }
+        if (cache_writer && !cache_writer->append(time_ns, tick.price, tick.askVolume, tick.bidVolume, tick.id)) {
+            cache_writer.reset();
+        }
+        last_tick = tick;
+        unmarked_ticks = true;
+    }
+
+    // Stores the last tick appended since the previous call as the watermark of table_name
+    // (partitioned output only). Ticks arrive in id order, so it is the highest id written.
+    void mark_watermark(const std::string& table_name) {
+        if (partitioned_writer && unmarked_ticks) {
+            partitioned_writer->set_watermark(table_name, last_tick.id, last_tick.dateTime.time_since_epoch().count());
+        }
+        unmarked_ticks = false;
+    }
+
+    // Closes the files and returns the number of ticks written, 0 if the table had none.
+    int64_t finish(const std::string& table_name) {
+        int64_t rows = 0;
+        if (partitioned_writer) {
+            partitioned_writer->close();
+            rows = partitioned_writer->rows();
+            log_line(std::cout, "Successfully wrote " + std::to_string(rows) + " ticks in " +
+                                std::to_string(partitioned_writer->files()) + " partition files to " + parquet_path);
+        } else if (parquet_writer) {
+            parquet_writer->close();
+            rows = parquet_writer->rows();
+            log_line(std::cout, "Successfully wrote " + std::to_string(rows) + " ticks to " + parquet_path);
+        } else {
+            log_line(std::cout, "No data found in table " + table_name + ", skipping.");
+            return 0;
+        }
+        if (cache_writer && cache_writer->finish()) {
+            log_line(std::cout, "Successfully wrote " + cache_path);
+        }
+        return rows;
+    }
+
+private:
+    std::string output_dir;
+    std::string parquet_path;
+    std::string cache_path;
+    const CleanerOptions& options;
+    bool partitioned;
+    DatasetManifest previous;
+    ProcessedTick last_tick = {};
+    bool unmarked_ticks = false;
+    std::unique_ptr<ParquetTickWriter> parquet_writer;
+    std::unique_ptr<PartitionedTickWriter> partitioned_writer;
+    std::unique_ptr<TickCacheWriter> cache_writer;
+};
+
+// Ids per chunk when a table is read in ranges, and how many converted chunks may wait for the writer per reader.
+constexpr int64_t RANGE_CHUNK_IDS = 262144;
+constexpr size_t RANGE_CHUNKS_PER_READER = 4;
+
+// Smallest and largest id of a table above after_id. Returns false if there are no such rows or
+// if id range reads would not be served by an index.
+bool indexed_id_span(SQLite::Database& db, const std::string& table_name, int64_t after_id, int64_t& min_id, int64_t& max_id) {
+    // A range read without an index on id would scan the whole table once per chunk.
+    SQLite::Statement plan(db, "EXPLAIN QUERY PLAN " + TICK_COLUMNS + table_name + "\" WHERE id >= ? AND id < ? ORDER BY id");
+    bool searches = false;
+    while (plan.executeStep()) {
+        const std::string detail = plan.getColumn(3).getString();
+        searches = searches || detail.find("SEARCH") != std::string::npos;
+    }
+    if (!searches) {
+        return false;
+    }
+
+    SQLite::Statement span(db, "SELECT MIN(id), MAX(id) FROM \"" + table_name + "\" WHERE id > ?");
+    span.bind(1, static_cast<long long>(after_id));
+    if (!span.executeStep() || span.getColumn(0).isNull()) {
+        return false;
+    }
+    min_id = span.getColumn(0).getInt64();
+    max_id = span.getColumn(1).getInt64();
+    return true;
+}
+
+// Reads the table as consecutive id chunks on `table_jobs` threads, each with its own connection, while
+// the calling thread appends the converted chunks to the output strictly in id order.
+// Readers may only run RANGE_CHUNKS_PER_READER chunks per thread ahead of the writer, which bounds memory.
+// The ticks reach the output in exactly the order of the serial ORDER BY id query.
+void read_table_in_ranges(
+    const std::string& db_path,
+    const std::string& table_name,
+    int64_t min_id,
+    int64_t max_id,
+    const CleanerOptions& options,
+    TableOutput& output)
 {
-    if (buffer.empty()) {
-        std::cout << "Buffer is empty, skipping write." << std::endl;
-        return;
-    }
-
-    std::cout << "Writing " << buffer.size() << " total ticks to " << output_path << "..." << std::endl;
-
-    // --- Arrow Builders for each column ---
-    arrow::Int64Builder id_builder;
-    arrow::TimestampBuilder time_builder(arrow::timestamp(arrow::TimeUnit::NANO), arrow::default_memory_pool());
-    arrow::DoubleBuilder price_builder;
-    arrow::Int64Builder ask_vol_builder;
-    arrow::Int64Builder bid_vol_builder;
-
-    // Append data from our buffer to the Arrow builders
-    for (const auto& tick : buffer) {
-        ARROW_CHECK_OK(id_builder.Append(tick.id));
-        ARROW_CHECK_OK(time_builder.Append(tick.dateTime.time_since_epoch().count()));
-        ARROW_CHECK_OK(price_builder.Append(tick.price));
-        ARROW_CHECK_OK(ask_vol_builder.Append(tick.askVolume));
-        ARROW_CHECK_OK(bid_vol_builder.Append(tick.bidVolume));
-    }
-
-    // Finalize the arrays
-    std::shared_ptr<arrow::Array> id_array, time_array, price_array, ask_array, bid_array;
-    ARROW_CHECK_OK(id_builder.Finish(&id_array));
-    ARROW_CHECK_OK(time_builder.Finish(&time_array));
-    ARROW_CHECK_OK(price_builder.Finish(&price_array));
-    ARROW_CHECK_OK(ask_vol_builder.Finish(&ask_array));
-    ARROW_CHECK_OK(bid_vol_builder.Finish(&bid_array));
-
-    // Define the schema for the Parquet file
-    auto schema = arrow::schema({
-        arrow::field("id", arrow::int64()),
-        arrow::field("DateTime", arrow::timestamp(arrow::TimeUnit::NANO)),
-        arrow::field("Price", arrow::float64()),
-        arrow::field("AskVolume", arrow::int64()),
-        arrow::field("BidVolume", arrow::int64())
-    });
-
-    auto table = arrow::Table::Make(schema, {id_array, time_array, price_array, ask_array, bid_array});
-
-    // --- Configure and write the Parquet file ---
-    std::shared_ptr<arrow::io::FileOutputStream> outfile;
-    PARQUET_ASSIGN_OR_THROW(outfile, arrow::io::FileOutputStream::Open(output_path));
-
-    parquet::WriterProperties::Builder properties_builder;
-    properties_builder.compression(arrow::Compression::SNAPPY);
-
-    PARQUET_THROW_NOT_OK(parquet::arrow::WriteTable(*table, arrow::default_memory_pool(), outfile, 1000000, properties_builder.build()));
-    std::cout << "Successfully wrote " << output_path << std::endl;
+    struct Chunk {
+        std::vector<ProcessedTick> ticks;
+        bool ready = false;
+    };
+
+    const int64_t chunk_count = (max_id - min_id) / RANGE_CHUNK_IDS + 1;
+    const size_t window = RANGE_CHUNKS_PER_READER * options.table_jobs;
+    std::vector<Chunk> slots(window);   // chunk c is handed over in slot c % window
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    int64_t next_chunk = 0;       // next chunk a reader claims
+    int64_t written_chunks = 0;   // chunks the writer has taken
+    std::string error;            // first failure, stops every thread
+
+    auto reader = [&]() {
+        try {
+            SQLite::Database db(db_path, SQLite::OPEN_READONLY);
+            SQLite::Statement query(db, TICK_COLUMNS + table_name + "\" WHERE id >= ? AND id < ? ORDER BY id");
+            NewYorkClock ny_clock;
+
+            while (true) {
+                int64_t chunk;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    changed.wait(lock, [&]() {
+                        return !error.empty() || next_chunk >= chunk_count ||
+                               next_chunk < written_chunks + static_cast<int64_t>(window);
+                    });
+                    if (!error.empty() || next_chunk >= chunk_count) {
+                        return;
+                    }
+                    chunk = next_chunk++;
+                }
+
+                std::vector<ProcessedTick> ticks;
+                const int64_t from = min_id + chunk * RANGE_CHUNK_IDS;
+                query.reset();
+                query.bind(1, static_cast<long long>(from));
+                query.bind(2, static_cast<long long>(from + RANGE_CHUNK_IDS));
+                ProcessedTick tick;
+                while (query.executeStep()) {
+                    if (convert_row(query, ny_clock, tick)) {
+                        ticks.push_back(tick);
+                    }
+                }
+
+                std::lock_guard<std::mutex> lock(mutex);
+                slots[chunk % window].ticks = std::move(ticks);
+                slots[chunk % window].ready = true;
+                changed.notify_all();
+            }
+        } catch (const std::exception& e) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (error.empty()) {
+                error = e.what();
+            }
+            changed.notify_all();
+        }
+    };
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < options.table_jobs; ++r) {
+        readers.emplace_back(reader);
+    }
+
+    try {
+        for (int64_t chunk = 0; chunk < chunk_count; ++chunk) {
+            std::vector<ProcessedTick> ticks;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                Chunk& slot = slots[chunk % window];
+                changed.wait(lock, [&]() { return slot.ready || !error.empty(); });
+                if (!error.empty()) {
+                    break;
+                }
+                ticks = std::move(slot.ticks);
+                slot.ticks.clear();
+                slot.ready = false;
+                ++written_chunks;
+                changed.notify_all();
+            }
+            for (const auto& tick : ticks) {
+                output.append(tick);
+            }
+        }
+    } catch (const std::exception& e) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (error.empty()) {
+            error = e.what();
+        }
+        changed.notify_all();
+    }
+
+    for (auto& thread : readers) {
+        thread.join();
+    }
+    if (!error.empty()) {
+        throw std::runtime_error(error);
+    }
 }
 
 // Processes all ticks from a SINGLE contract table.
-void process_table(
+// Ticks are streamed into the output files as they are read, nothing is buffered per table.
+// With --table-jobs the table is read in id ranges on several connections, the output is the same.
+TableResult process_table(
+    const std::string& db_path,
     SQLite::Database& db,
     const std::string& table_name,
-    const std::string& output_dir)
+    const std::string& output_dir,
+    const CleanerOptions& options)
 {
-    std::cout << "--- Processing table: " << table_name << " ---" << std::endl;
+    TableResult result;
+    result.table_name = table_name;
+
+    log_line(std::cout, "--- Processing table: " + table_name + " ---");
     try {
-        SQLite::Statement query(db, "SELECT id, \"Date\", \"Time\", \"Close\", \"AskVolume\", \"BidVolume\" FROM \"" + table_name + "\" ORDER BY id");
+        const std::string dataset_root = options.partitioned ? (std::filesystem::path(output_dir) / table_name).string() : "";
+
+        // Only rows after the watermark are read when an existing dataset is continued
+        DatasetManifest previous;
+        const TableWatermark* watermark = nullptr;
+        if (options.partitioned && read_manifest(dataset_root, previous)) {
+            if (options.incremental) {
+                watermark = previous.find_watermark(table_name);
+            } else {
+                remove_dataset_files(dataset_root, previous);
+                previous = DatasetManifest();
+            }
+        }
+        const int64_t after_id = watermark ? watermark->last_id : std::numeric_limits<int64_t>::min();
+        if (watermark) {
+            log_line(std::cout, "Continuing " + table_name + " after id " + std::to_string(watermark->last_id) +
+                                " (" + format_timestamp(watermark->last_time_ns) + ")");
+        }
 
-        std::vector<ProcessedTick> table_buffer;
-        // Reserve a large buffer to reduce re-allocations, can be tuned
-        table_buffer.reserve(2000000);
+        TableOutput output(table_name, output_dir, options, dataset_root, previous);
 
-        while(query.executeStep()) {
-            std::string date_str = query.getColumn("Date");
-            std::string time_str = query.getColumn("Time");
-            std::string utc_time_str = date_str + " " + time_str;
+        int64_t min_id = 0, max_id = 0;
+        if (options.table_jobs > 1 && indexed_id_span(db, table_name, after_id, min_id, max_id)) {
+            read_table_in_ranges(db_path, table_name, min_id, max_id, options, output);
+        } else {
+            if (options.table_jobs > 1) {
+                log_line(std::cout, "Table " + table_name + " has no usable id index or no new rows, reading it serially.");
+            }
+            SQLite::Statement query(db, TICK_COLUMNS + table_name + (watermark ? "\" WHERE id > ? ORDER BY id" : "\" ORDER BY id"));
+            if (watermark) {
+                query.bind(1, static_cast<long long>(after_id));
+            }
+            NewYorkClock ny_clock;
+            ProcessedTick tick;
+            while(query.executeStep()) {
+                if (convert_row(query, ny_clock, tick)) {
+                    output.append(tick);
+                }
+            }
+        }
 
-            std::chrono::system_clock::time_point utc_timepoint;
-            std::istringstream ss(utc_time_str);
-            ss >> date::parse("%Y/%m/%d %H:%M:%S", utc_timepoint);
+        output.mark_watermark(table_name);
+        result.rows = output.finish(table_name);
 
-            if (ss.fail()) {
-                std::cerr << "Warning: Failed to parse timestamp: " << utc_time_str << std::endl;
-                continue;
-            }
+    } catch (const std::exception& e) {
+        result.error = e.what();
+        log_line(std::cerr, "Error processing table " + table_name + ": " + result.error);
+    }
+    return result;
+}
 
-            // Convert UTC to New York local time
-            date::zoned_time<std::chrono::nanoseconds> ny_time{"America/New_York", utc_timepoint};
-            auto ny_local_time = ny_time.get_local_time();
+// "YYYY/MM/DD" of the (New York local) day of ns, the format of the raw Date column.
+std::string raw_date(int64_t ns) {
+    const int64_t ns_per_day = 86400LL * 1000000000LL;
+    int year;
+    unsigned month, day;
+    civil_from_days(ns >= 0 ? ns / ns_per_day : (ns + 1) / ns_per_day - 1, year, month, day);
+    char text[16];
+    std::snprintf(text, sizeof(text), "%04d/%02u/%02u", year, month, day);
+    return text;
+}
 
-            ProcessedTick tick;
-            tick.id = query.getColumn("id");
-            // Store a time_point representing the local New York time
-            tick.dateTime = std::chrono::system_clock::time_point(ny_local_time.time_since_epoch());
-            tick.price = query.getColumn("Close");
-            tick.askVolume = query.getColumn("AskVolume");
-            tick.bidVolume = query.getColumn("BidVolume");
+// Roll map mode: builds the continuous contract from the most traded table of every day and streams
+// those days, in date order, into one day partitioned dataset (and continuous.ticks) in output_dir.
+TableResult process_roll_map(
+    SQLite::Database& db,
+    const std::vector<std::string>& table_names,
+    const std::string& output_dir,
+    const CleanerOptions& options)
+{
+    TableResult result;
+    result.table_name = "roll map";
 
-            table_buffer.push_back(tick);
+    try {
+        log_line(std::cout, "--- Building roll map over " + std::to_string(table_names.size()) + " tables ---");
+        DatasetManifest previous;
+        if (read_manifest(output_dir, previous) && !options.incremental) {
+            remove_dataset_files(output_dir, previous);
+            previous = DatasetManifest();
         }
 
-        if (!table_buffer.empty()) {
-            std::filesystem::path output_path(output_dir);
-            std::filesystem::create_directories(output_path);
-            output_path /= (table_name + ".parquet");
-            write_table_to_parquet(table_buffer, output_path.string());
-        } else {
-            std::cout << "No data found in table " << table_name << ", skipping." << std::endl;
+        // The last day written is usually partial (the evening session crosses UTC midnight), so the days an
+        // earlier run wrote keep its table even if another contract has since become the most traded one.
+        std::vector<RollRun> pinned;
+        for (const auto& run : previous.roll_runs) {
+            pinned.push_back({run.table_name, run.first_date, run.last_date, 0});
+        }
+        const std::vector<RollRun> runs = build_roll_map(db, table_names, pinned);
+        for (const auto& run : runs) {
+            log_line(std::cout, run.first_date + " - " + run.last_date + " (" + std::to_string(run.days) + " days): " + run.table_name);
+        }
+
+        // The manifest written at the end records the days of this map as taken from their tables.
+        previous.roll_runs.clear();
+        for (const auto& run : runs) {
+            previous.roll_runs.push_back({run.table_name, run.first_date, run.last_date});
+        }
+
+        // With --incremental, runs that end before the New York date of the newest tick written are done.
+        // Raw dates are UTC, never earlier than the New York date, so this only skips finished days;
+        // the per table id watermarks keep the remaining runs from writing a row twice.
+        std::string resume_date;
+        for (const auto& watermark : previous.watermarks) {
+            resume_date = std::max(resume_date, raw_date(watermark.last_time_ns));
+        }
+        if (!resume_date.empty()) {
+            log_line(std::cout, "Continuing the continuous contract from " + resume_date);
         }
 
+        TableOutput output("continuous", output_dir, options, output_dir, previous);
+        NewYorkClock ny_clock;
+        ProcessedTick tick;
+        for (const auto& run : runs) {
+            if (run.last_date < resume_date) {
+                continue;
+            }
+            const TableWatermark* watermark = previous.find_watermark(run.table_name);
+
+            // Raw dates are zero padded "YYYY/MM/DD", so the text range selects exactly the run's days
+            SQLite::Statement query(db, TICK_COLUMNS + run.table_name + "\" WHERE \"Date\" >= ? AND \"Date\" <= ? AND id > ? ORDER BY id");
+            query.bind(1, run.first_date);
+            query.bind(2, run.last_date);
+            query.bind(3, static_cast<long long>(watermark ? watermark->last_id : std::numeric_limits<int64_t>::min()));
+            while (query.executeStep()) {
+                if (convert_row(query, ny_clock, tick)) {
+                    output.append(tick);
+                }
+            }
+            output.mark_watermark(run.table_name);
+        }
+        result.rows = output.finish(result.table_name);
+
     } catch (const std::exception& e) {
-        std::cerr << "Error processing table " << table_name << ": " << e.what() << std::endl;
+        result.error = e.what();
+        log_line(std::cerr, "Error building continuous contract: " + result.error);
+    }
+    return result;
+}
+
+// Converts every table on `jobs` worker threads, each with its own read-only connection.
+// Workers pick the next unprocessed table until none is left; results come back in table order.
+std::vector<TableResult> process_tables(
+    const std::string& db_path,
+    const std::vector<std::string>& table_names,
+    const std::string& output_dir,
+    const CleanerOptions& options)
+{
+    std::vector<TableResult> results(table_names.size());
+    for (size_t i = 0; i < table_names.size(); ++i) {
+        results[i].table_name = table_names[i];
+        results[i].error = "not processed";
+    }
+
+    std::atomic<size_t> next_table{0};
+    std::atomic<size_t> finished_tables{0};
+
+    auto worker = [&]() {
+        try {
+            SQLite::Database db(db_path, SQLite::OPEN_READONLY);
+            for (size_t i = next_table++; i < table_names.size(); i = next_table++) {
+                results[i] = process_table(db_path, db, table_names[i], output_dir, options);
+                const size_t finished = ++finished_tables;
+                log_line(std::cout, "Progress: " + std::to_string(finished) + "/" + std::to_string(table_names.size()) +
+                                    " tables (" + table_names[i] + (results[i].error.empty() ? " done)" : " failed)"));
+            }
+        } catch (const std::exception& e) {
+            log_line(std::cerr, std::string("Worker failed to open database: ") + e.what());
+        }
+    };
+
+    const size_t worker_count = std::min<size_t>(options.jobs, table_names.size());
+    if (worker_count <= 1) {
+        worker();
+        return results;
+    }
+
+    std::vector<std::thread> workers;
+    for (size_t w = 0; w < worker_count; ++w) {
+        workers.emplace_back(worker);
     }
+    for (auto& thread : workers) {
+        thread.join();
+    }
+    return results;
 }
 
 // Gets the names of all tables in the database, excluding sqlite system tables.
@@ -154,32 +527,186 @@ std::vector<std::string> get_table_names(SQLite::Database& db) {
 }
 
 
+void print_usage(const char* program) {
+    std::cerr << "Usage: " << program << " <db_path> <output_directory> [options]\n"
+              << "Options:\n"
+              << "  --tables <a,b,...>         only convert these tables (default: every table)\n"
+              << "  --roll-map                 build one continuous contract from the most traded table of each day,\n"
+              << "                             written as a year=/month=/day= partitioned dataset\n"
+              << "  --partitioned              write <table>/year=/month=/day=/data.parquet datasets instead of <table>.parquet\n"
+              << "  --session-start <HH:MM>    New York time a day partition starts at, e.g. 18:00 (default 00:00)\n"
+              << "  --incremental              only convert rows after the watermarks in each dataset's _manifest and\n"
+              << "                             add them as new partition files (implies --partitioned)\n"
+              << "  --jobs <n>                 tables converted in parallel, one connection each (default 1)\n"
+              << "  --table-jobs <n>           reader threads per table, each on its own id range (default 1)\n"
+              << "  --row-group-size <n>       rows per Parquet row group (default 1000000)\n"
+              << "  --compact                  int32 tick prices and volumes, delta encoded timestamps, page indexes,\n"
+              << "                             zstd unless --compression is given\n"
+              << "  --compression <codec>      snappy, zstd, gzip, lz4, brotli or uncompressed (default snappy)\n"
+              << "  --compression-level <n>    codec specific compression level (default: codec default)\n"
+              << "  --tick-cache               also write <table>.ticks, a memory mappable tick cache for footprint_trainer\n"
+              << "  --tick-size <x>            price of one tick for the tick cache and --compact (default 0.25)" << std::endl;
+}
+
+// Parses the flags after the positional arguments, prints the problem and returns false on bad input.
+bool parse_options(int argc, char* argv[], CleanerOptions& options) {
+    bool compression_given = false;
+    try {
+        for (int i = 3; i < argc; ++i) {
+            const std::string arg(argv[i]);
+            const bool has_value = i + 1 < argc;
+            if (arg == "--jobs" && has_value) {
+                options.jobs = std::stoi(argv[++i]);
+            } else if (arg == "--table-jobs" && has_value) {
+                options.table_jobs = std::stoi(argv[++i]);
+            } else if (arg == "--partitioned") {
+                options.partitioned = true;
+            } else if (arg == "--session-start" && has_value) {
+                int hours = 0, minutes = 0;
+                char separator = 0;
+                std::istringstream value(argv[++i]);
+                if (!(value >> hours >> separator >> minutes) || separator != ':' ||
+                    hours < 0 || hours > 23 || minutes < 0 || minutes > 59) {
+                    std::cerr << "--session-start expects HH:MM" << std::endl;
+                    return false;
+                }
+                options.session_start_minutes = hours * 60 + minutes;
+            } else if (arg == "--incremental") {
+                options.incremental = true;
+            } else if (arg == "--roll-map") {
+                options.roll_map = true;
+            } else if (arg == "--tables" && has_value) {
+                std::istringstream list(argv[++i]);
+                std::string table;
+                while (std::getline(list, table, ',')) {
+                    if (!table.empty()) {
+                        options.tables.push_back(table);
+                    }
+                }
+            } else if (arg == "--compact") {
+                options.parquet.compact = true;
+            } else if (arg == "--tick-cache") {
+                options.tick_cache = true;
+            } else if (arg == "--tick-size" && has_value) {
+                options.tick_size = std::stod(argv[++i]);
+            } else if (arg == "--row-group-size" && has_value) {
+                options.parquet.row_group_size = std::stoll(argv[++i]);
+            } else if (arg == "--compression" && has_value) {
+                auto codec = arrow::util::Codec::GetCompressionType(argv[++i]);
+                if (!codec.ok() || !arrow::util::Codec::IsAvailable(*codec)) {
+                    std::cerr << "Unsupported compression: " << argv[i] << std::endl;
+                    return false;
+                }
+                options.parquet.compression = *codec;
+                compression_given = true;
+            } else if (arg == "--compression-level" && has_value) {
+                options.parquet.compression_level = std::stoi(argv[++i]);
+            } else {
+                std::cerr << "Unknown option: " << arg << std::endl;
+                return false;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Invalid option value: " << e.what() << std::endl;
+        return false;
+    }
+
+    if (options.tick_size <= 0.0) {
+        std::cerr << "--tick-size must be positive" << std::endl;
+        return false;
+    }
+    options.parquet.tick_size = options.tick_size;
+    if (options.parquet.compact && !compression_given) {
+        options.parquet.compression = arrow::Compression::ZSTD;
+    }
+    if (options.parquet.row_group_size <= 0) {
+        std::cerr << "--row-group-size must be positive" << std::endl;
+        return false;
+    }
+    if (options.incremental) {
+        if (options.tick_cache) {
+            std::cerr << "--tick-cache can't be combined with --incremental, the cache is written in one piece" << std::endl;
+            return false;
+        }
+        // only partitioned datasets can grow by adding files
+        options.partitioned = true;
+    }
+    if (options.jobs < 1 || options.table_jobs < 1) {
+        std::cerr << "--jobs and --table-jobs must be at least 1" << std::endl;
+        return false;
+    }
+    // Parquet's threaded column encoding can deadlock when several files are written on the same
+    // executor, the table workers are the parallelism then.
+    if (options.jobs > 1) {
+        options.parquet.use_threads = false;
+    }
+    return true;
+}
+
+
 int main(int argc, char* argv[]) {
-    if (argc != 3) {
-        std::cerr << "Usage: " << argv[0] << " <db_path> <output_directory>" << std::endl;
+    if (argc < 3) {
+        print_usage(argv[0]);
         return 1;
     }
 
     const std::string db_path(argv[1]);
     const std::string output_dir(argv[2]);
 
-    try {
-        SQLite::Database db(db_path, SQLite::OPEN_READONLY);
-        std::cout << "Successfully opened database: " << db_path << std::endl;
+    CleanerOptions options;
+    if (!parse_options(argc, argv, options)) {
+        print_usage(argv[0]);
+        return 1;
+    }
 
-        std::vector<std::string> table_names = get_table_names(db);
-        std::cout << "Found " << table_names.size() << " tables to process." << std::endl;
+    std::vector<TableResult> results;
+    try {
+        std::vector<std::string> table_names;
+        {
+            SQLite::Database db(db_path, SQLite::OPEN_READONLY);
+            std::cout << "Successfully opened database: " << db_path << std::endl;
+            table_names = get_table_names(db);
+            if (!options.tables.empty()) {
+                for (const auto& table : options.tables) {
+                    if (std::find(table_names.begin(), table_names.end(), table) == table_names.end()) {
+                        throw std::runtime_error("Table not found: " + table);
+                    }
+                }
+                table_names = options.tables;
+            }
+            std::cout << "Found " << table_names.size() << " tables to process." << std::endl;
 
-        for (const auto& table_name : table_names) {
-            process_table(db, table_name, output_dir);
+            if (options.roll_map) {
+                results.push_back(process_roll_map(db, table_names, output_dir, options));
+            }
         }
 
-        std::cout << "\nAll processing complete." << std::endl;
+        if (!options.roll_map) {
+            results = process_tables(db_path, table_names, output_dir, options);
+        }
 
     } catch (const std::exception& e) {
         std::cerr << "Critical Error: " << e.what() << std::endl;
         return 1;
     }
 
+    int64_t total_rows = 0;
+    size_t failed = 0;
+    for (const auto& result : results) {
+        total_rows += result.rows;
+        failed += result.error.empty() ? 0 : 1;
+    }
+    std::cout << "\nAll processing complete. " << results.size() - failed << "/" << results.size()
+              << " tables converted, " << total_rows << " ticks written." << std::endl;
+    if (failed > 0) {
+        std::cerr << failed << " table(s) failed:" << std::endl;
+        for (const auto& result : results) {
+            if (!result.error.empty()) {
+                std::cerr << "  " << result.table_name << ": " << result.error << std::endl;
+            }
+        }
+        return 1;
+    }
+
     return 0;
 }
@@ -0,0 +1,123 @@
+#include "manifest.h"
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include "timestamps.h"
+
+namespace {
+
+int64_t parse_time_field(const std::string& text, const std::string& line) {
+    int64_t ns;
+    if (!parse_timestamp(text.c_str(), ns)) {
+        throw std::runtime_error("Bad timestamp in manifest line: " + line);
+    }
+    return ns;
+}
+
+} // namespace
+
+
+const TableWatermark* DatasetManifest::find_watermark(const std::string& table_name) const {
+    for (const auto& watermark : watermarks) {
+        if (watermark.table_name == table_name) {
+            return &watermark;
+        }
+    }
+    return nullptr;
+}
+
+
+void DatasetManifest::set_watermark(const std::string& table_name, int64_t last_id, int64_t last_time_ns) {
+    for (auto& watermark : watermarks) {
+        if (watermark.table_name == table_name) {
+            watermark.last_id = last_id;
+            watermark.last_time_ns = last_time_ns;
+            return;
+        }
+    }
+    watermarks.push_back({table_name, last_id, last_time_ns});
+}
+
+
+void write_manifest(const std::string& root, const DatasetManifest& manifest) {
+    const std::filesystem::path path = std::filesystem::path(root) / "_manifest";
+    const std::filesystem::path temp_path = std::filesystem::path(root) / "_manifest.tmp";
+
+    {
+        std::ofstream out(temp_path, std::ios::trunc);
+        out << "# kind\tpath\trows\tmin_id\tmax_id\tmin_time\tmax_time\n";
+        for (const auto& partition : manifest.partitions) {
+            out << "partition\t" << partition.path << '\t' << partition.rows << '\t'
+                << partition.min_id << '\t' << partition.max_id << '\t'
+                << format_timestamp(partition.min_time_ns) << '\t' << format_timestamp(partition.max_time_ns) << '\n';
+        }
+        out << "# kind\ttable\tlast_id\tlast_time\n";
+        for (const auto& watermark : manifest.watermarks) {
+            out << "watermark\t" << watermark.table_name << '\t' << watermark.last_id << '\t'
+                << format_timestamp(watermark.last_time_ns) << '\n';
+        }
+        if (!manifest.roll_runs.empty()) {
+            out << "# kind\ttable\tfirst_date\tlast_date\n";
+        }
+        for (const auto& run : manifest.roll_runs) {
+            out << "roll\t" << run.table_name << '\t' << run.first_date << '\t' << run.last_date << '\n';
+        }
+        out.close();
+        if (!out) {
+            throw std::runtime_error("Can't write manifest: " + temp_path.string());
+        }
+    }
+    std::filesystem::rename(temp_path, path);
+}
+
+
+bool read_manifest(const std::string& root, DatasetManifest& manifest) {
+    std::ifstream in(std::filesystem::path(root) / "_manifest");
+    if (!in) {
+        return false;
+    }
+
+    manifest = DatasetManifest();
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::vector<std::string> fields;
+        std::istringstream stream(line);
+        std::string field;
+        while (std::getline(stream, field, '\t')) {
+            fields.push_back(field);
+        }
+
+        if (fields[0] == "partition" && fields.size() == 7) {
+            ManifestPartition partition;
+            partition.path = fields[1];
+            partition.rows = std::stoll(fields[2]);
+            partition.min_id = std::stoll(fields[3]);
+            partition.max_id = std::stoll(fields[4]);
+            partition.min_time_ns = parse_time_field(fields[5], line);
+            partition.max_time_ns = parse_time_field(fields[6], line);
+            manifest.partitions.push_back(partition);
+        } else if (fields[0] == "watermark" && fields.size() == 4) {
+            manifest.set_watermark(fields[1], std::stoll(fields[2]), parse_time_field(fields[3], line));
+        } else if (fields[0] == "roll" && fields.size() == 4) {
+            manifest.roll_runs.push_back({fields[1], fields[2], fields[3]});
+        } else {
+            throw std::runtime_error("Bad manifest line: " + line);
+        }
+    }
+    return true;
+}
+
+
+void remove_dataset_files(const std::string& root, const DatasetManifest& manifest) {
+    std::error_code ec;
+    for (const auto& partition : manifest.partitions) {
+        std::filesystem::remove(std::filesystem::path(root) / partition.path, ec);
+    }
+    std::filesystem::remove(std::filesystem::path(root) / "_manifest", ec);
+}
@@ -0,0 +1,57 @@
+#ifndef MANIFEST_H
+#define MANIFEST_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// One Parquet file of a partitioned dataset.
+struct ManifestPartition {
+    std::string path;        // relative to the dataset root, e.g. year=2024/month=03/day=04/data.parquet
+    int64_t rows = 0;
+    int64_t min_id = 0;
+    int64_t max_id = 0;
+    int64_t min_time_ns = 0;  // New York local time
+    int64_t max_time_ns = 0;
+};
+
+// Last row of a source table that made it into the dataset, --incremental continues after it.
+struct TableWatermark {
+    std::string table_name;
+    int64_t last_id = 0;
+    int64_t last_time_ns = 0;   // New York local time
+};
+
+// Raw dates [first_date, last_date] ("YYYY/MM/DD") that the roll map took from table_name (--roll-map datasets).
+// A rerun with --incremental keeps these choices, a day already written is never continued from another table.
+struct ManifestRollRun {
+    std::string table_name;
+    std::string first_date;
+    std::string last_date;
+};
+
+// Contents of the _manifest file at the root of a partitioned dataset.
+struct DatasetManifest {
+    std::vector<ManifestPartition> partitions;
+    std::vector<TableWatermark> watermarks;
+    std::vector<ManifestRollRun> roll_runs;   // chronological
+
+    // nullptr if the table has never been written to the dataset
+    const TableWatermark* find_watermark(const std::string& table_name) const;
+    void set_watermark(const std::string& table_name, int64_t last_id, int64_t last_time_ns);
+};
+
+// Writes <root>/_manifest, a tab separated text file with one line per partition file and per table:
+//   partition <path> <rows> <min_id> <max_id> <min_time> <max_time>
+//   watermark <table> <last_id> <last_time>
+//   roll <table> <first_date> <last_date>
+// Times are written as "YYYY-MM-DD HH:MM:SS.nnnnnnnnn". The file is replaced atomically.
+void write_manifest(const std::string& root, const DatasetManifest& manifest);
+
+// Reads <root>/_manifest. Returns false if the dataset has none, throws if it can't be parsed.
+bool read_manifest(const std::string& root, DatasetManifest& manifest);
+
+// Deletes the partition files a manifest lists, and the manifest itself, before a dataset is rewritten.
+void remove_dataset_files(const std::string& root, const DatasetManifest& manifest);
+
+#endif // MANIFEST_H
@@ -0,0 +1,157 @@
+#include "parquet_tick_writer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+
+#include <parquet/exception.h>
+
+namespace {
+
+// Upper bound for the rows buffered as Arrow arrays before they are encoded.
+constexpr int64_t MAX_BATCH_ROWS = 65536;
+
+} // namespace
+
+
+std::shared_ptr<arrow::Schema> tick_schema() {
+    return arrow::schema({
+        arrow::field("id", arrow::int64()),
+        arrow::field("DateTime", arrow::timestamp(arrow::TimeUnit::NANO)),
+        arrow::field("Price", arrow::float64()),
+        arrow::field("AskVolume", arrow::int64()),
+        arrow::field("BidVolume", arrow::int64())
+    });
+}
+
+
+std::shared_ptr<arrow::Schema> compact_tick_schema(double tick_size) {
+    // %.17g round trips the double, 0.25 is stored as "0.25".
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.17g", tick_size);
+    return arrow::schema({
+        arrow::field("id", arrow::int64()),
+        arrow::field("DateTime", arrow::timestamp(arrow::TimeUnit::NANO)),
+        arrow::field("Price", arrow::int32()),
+        arrow::field("AskVolume", arrow::int32()),
+        arrow::field("BidVolume", arrow::int32())
+    }, arrow::key_value_metadata({COMPACT_TICK_SIZE_KEY}, {text}));
+}
+
+
+ParquetTickWriter::ParquetTickWriter(const std::string& path, const ParquetWriterOptions& options)
+    : path(path),
+      compact(options.compact),
+      tick_size(options.tick_size),
+      batch_size(std::min(options.row_group_size, MAX_BATCH_ROWS)),
+      schema(options.compact ? compact_tick_schema(options.tick_size) : tick_schema()),
+      time_builder(arrow::timestamp(arrow::TimeUnit::NANO), arrow::default_memory_pool()) {
+    PARQUET_ASSIGN_OR_THROW(outfile, arrow::io::FileOutputStream::Open(path));
+
+    parquet::WriterProperties::Builder properties_builder;
+    properties_builder.compression(options.compression);
+    properties_builder.compression_level(options.compression_level);
+    properties_builder.max_row_group_length(options.row_group_size);
+    if (compact) {
+        // id and DateTime only ever grow by small steps, delta packing beats a dictionary of unique values.
+        // Price and the volumes repeat a lot and keep the default dictionary encoding.
+        for (const char* column : {"id", "DateTime"}) {
+            properties_builder.disable_dictionary(column);
+            properties_builder.encoding(column, parquet::Encoding::DELTA_BINARY_PACKED);
+        }
+        // Min/max per row group and per page let readers skip everything outside the requested time range.
+        properties_builder.enable_statistics();
+        properties_builder.enable_write_page_index();
+    }
+
+    parquet::ArrowWriterProperties::Builder arrow_properties_builder;
+    arrow_properties_builder.set_use_threads(options.use_threads);
+    if (compact) {
+        // Writes the schema metadata (the tick size) into the file footer.
+        arrow_properties_builder.store_schema();
+    }
+
+    PARQUET_ASSIGN_OR_THROW(writer, parquet::arrow::FileWriter::Open(
+        *schema, arrow::default_memory_pool(), outfile, properties_builder.build(), arrow_properties_builder.build()));
+
+    reserve_batch();
+}
+
+
+ParquetTickWriter::~ParquetTickWriter() {
+    if (!closed) {
+        // An unfinished file has no footer, don't leave it behind for the readers.
+        writer.reset();
+        (void)outfile->Close();
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+    }
+}
+
+
+void ParquetTickWriter::append(int64_t id, int64_t date_time_ns, double price, int64_t ask_volume, int64_t bid_volume) {
+    id_builder.UnsafeAppend(id);
+    time_builder.UnsafeAppend(date_time_ns);
+    if (compact) {
+        price_tick_builder.UnsafeAppend(static_cast<int32_t>(std::llround(price / tick_size)));
+        ask_vol32_builder.UnsafeAppend(static_cast<int32_t>(ask_volume));
+        bid_vol32_builder.UnsafeAppend(static_cast<int32_t>(bid_volume));
+    } else {
+        price_builder.UnsafeAppend(price);
+        ask_vol_builder.UnsafeAppend(ask_volume);
+        bid_vol_builder.UnsafeAppend(bid_volume);
+    }
+    row_count++;
+
+    if (id_builder.length() == batch_size) {
+        write_batch();
+        reserve_batch();
+    }
+}
+
+
+void ParquetTickWriter::close() {
+    if (id_builder.length() > 0) {
+        write_batch();
+    }
+    PARQUET_THROW_NOT_OK(writer->Close());
+    PARQUET_THROW_NOT_OK(outfile->Close());
+    closed = true;
+}
+
+
+void ParquetTickWriter::reserve_batch() {
+    PARQUET_THROW_NOT_OK(id_builder.Reserve(batch_size));
+    PARQUET_THROW_NOT_OK(time_builder.Reserve(batch_size));
+    if (compact) {
+        PARQUET_THROW_NOT_OK(price_tick_builder.Reserve(batch_size));
+        PARQUET_THROW_NOT_OK(ask_vol32_builder.Reserve(batch_size));
+        PARQUET_THROW_NOT_OK(bid_vol32_builder.Reserve(batch_size));
+    } else {
+        PARQUET_THROW_NOT_OK(price_builder.Reserve(batch_size));
+        PARQUET_THROW_NOT_OK(ask_vol_builder.Reserve(batch_size));
+        PARQUET_THROW_NOT_OK(bid_vol_builder.Reserve(batch_size));
+    }
+}
+
+
+void ParquetTickWriter::write_batch() {
+    const int64_t length = id_builder.length();
+    std::shared_ptr<arrow::Array> id_array, time_array, price_array, ask_array, bid_array;
+    PARQUET_THROW_NOT_OK(id_builder.Finish(&id_array));
+    PARQUET_THROW_NOT_OK(time_builder.Finish(&time_array));
+    if (compact) {
+        PARQUET_THROW_NOT_OK(price_tick_builder.Finish(&price_array));
+        PARQUET_THROW_NOT_OK(ask_vol32_builder.Finish(&ask_array));
+        PARQUET_THROW_NOT_OK(bid_vol32_builder.Finish(&bid_array));
+    } else {
+        PARQUET_THROW_NOT_OK(price_builder.Finish(&price_array));
+        PARQUET_THROW_NOT_OK(ask_vol_builder.Finish(&ask_array));
+        PARQUET_THROW_NOT_OK(bid_vol_builder.Finish(&bid_array));
+    }
+
+    // Row groups are cut by max_row_group_length, a batch may end one row group and start the next.
+    auto batch = arrow::RecordBatch::Make(schema, length, {id_array, time_array, price_array, ask_array, bid_array});
+    PARQUET_THROW_NOT_OK(writer->WriteRecordBatch(*batch));
+}
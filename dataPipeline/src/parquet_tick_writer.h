@@ -0,0 +1,82 @@
+#ifndef PARQUET_TICK_WRITER_H
+#define PARQUET_TICK_WRITER_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include <arrow/api.h>
+#include <arrow/io/api.h>
+#include <arrow/util/compression.h>
+#include <parquet/arrow/writer.h>
+
+// How the Parquet files are laid out and compressed.
+struct ParquetWriterOptions {
+    int64_t row_group_size = 1000000;
+    arrow::Compression::type compression = arrow::Compression::SNAPPY;
+    int compression_level = arrow::util::kUseDefaultCompressionLevel;
+    // Encode the columns of a row group on the Arrow CPU pool.
+    bool use_threads = true;
+    // Compact schema: Price as int32 ticks of tick_size (stored in the file metadata), int32 volumes,
+    // delta encoded id/DateTime, page indexes. See compact_tick_schema().
+    bool compact = false;
+    double tick_size = 0.25;
+};
+
+// Streams ticks into a single Parquet file with the data_cleaner schema
+// (id, DateTime, Price, AskVolume, BidVolume), or its compact variant if options.compact is set.
+// Ticks are collected into fixed size record batches that are handed to the Parquet writer as soon as
+// they fill up, so memory is bounded by one batch plus one encoded row group instead of the whole table.
+class ParquetTickWriter {
+public:
+    ParquetTickWriter(const std::string& path, const ParquetWriterOptions& options);
+    ~ParquetTickWriter();
+
+    ParquetTickWriter(const ParquetTickWriter&) = delete;
+    ParquetTickWriter& operator=(const ParquetTickWriter&) = delete;
+
+    // date_time_ns is the New York local time as ns since epoch.
+    void append(int64_t id, int64_t date_time_ns, double price, int64_t ask_volume, int64_t bid_volume);
+
+    // Flushes the last batch and writes the footer. The file is deleted if the writer is destroyed without it.
+    void close();
+
+    int64_t rows() const { return row_count; }
+
+private:
+    void reserve_batch();
+    void write_batch();
+
+    std::string path;
+    bool compact;
+    double tick_size;
+    int64_t batch_size;
+    std::shared_ptr<arrow::Schema> schema;
+    std::shared_ptr<arrow::io::FileOutputStream> outfile;
+    std::unique_ptr<parquet::arrow::FileWriter> writer;
+
+    arrow::Int64Builder id_builder;
+    arrow::TimestampBuilder time_builder;
+    arrow::DoubleBuilder price_builder;
+    arrow::Int64Builder ask_vol_builder;
+    arrow::Int64Builder bid_vol_builder;
+
+    // Used instead of the three above by the compact schema.
+    arrow::Int32Builder price_tick_builder;
+    arrow::Int32Builder ask_vol32_builder;
+    arrow::Int32Builder bid_vol32_builder;
+
+    int64_t row_count = 0;
+    bool closed = false;
+};
+
+// Schema of every Parquet file written by data_cleaner.
+std::shared_ptr<arrow::Schema> tick_schema();
+
+// Schema written with --compact: same columns, Price holds round(price / tick_size) as int32 and both volumes are int32.
+// The tick size is kept in the file key/value metadata under COMPACT_TICK_SIZE_KEY.
+std::shared_ptr<arrow::Schema> compact_tick_schema(double tick_size);
+
+inline constexpr const char* COMPACT_TICK_SIZE_KEY = "tick_size";
+
+#endif // PARQUET_TICK_WRITER_H
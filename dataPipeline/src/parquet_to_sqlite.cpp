@@ -0,0 +1,333 @@
+// parquet_to_sqlite: loads data_cleaner Parquet output into the SQLite tick table footprint_trainer reads,
+// i.e. <table>(id INTEGER, DateTime TEXT, Price REAL, AskVolume INTEGER, BidVolume INTEGER) plus its
+// covering DateTime index.
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <stdexcept>
+#include <filesystem>
+#include <algorithm>
+#include <limits>
+#include <cstdint>
+
+// Database library
+#include <SQLiteCpp/SQLiteCpp.h>
+
+// Apache Arrow and Parquet libraries
+#include <arrow/api.h>
+#include <arrow/io/api.h>
+#include <parquet/arrow/reader.h>
+#include <parquet/metadata.h>
+#include <parquet/statistics.h>
+#include <parquet/exception.h>
+
+#include "timestamps.h"
+
+namespace {
+
+// Command line options of the loader.
+struct LoaderOptions {
+    int64_t from_ns = std::numeric_limits<int64_t>::min();   // first DateTime loaded (inclusive)
+    int64_t to_ns = std::numeric_limits<int64_t>::max();     // DateTime bound (exclusive)
+    int64_t commit_rows = 1000000;   // rows inserted per transaction
+    bool create_index = true;
+};
+
+// Column order the loader asks Arrow for, also the parameter order of the insert.
+enum TickColumn { COL_ID = 0, COL_DATETIME, COL_PRICE, COL_ASK, COL_BID, COL_COUNT };
+const char* TICK_COLUMN_NAMES[COL_COUNT] = {"id", "DateTime", "Price", "AskVolume", "BidVolume"};
+
+// The load runs without a rollback journal or fsyncs, a crash leaves a database that has to be loaded again.
+// The larger cache and in-memory temp store speed up the index build at the end.
+const char* LOAD_PRAGMAS =
+    "PRAGMA journal_mode = OFF;"
+    "PRAGMA synchronous = OFF;"
+    "PRAGMA temp_store = MEMORY;"
+    "PRAGMA cache_size = -262144;";
+
+
+// A single .parquet file, or every .parquet file below a directory in path order
+// (which is date order for the year=/month=/day= layout).
+std::vector<std::string> parquet_files(const std::string& path) {
+    std::vector<std::string> files;
+    if (std::filesystem::is_directory(path)) {
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(path)) {
+            if (entry.is_regular_file() && entry.path().extension() == ".parquet") {
+                files.push_back(entry.path().string());
+            }
+        }
+        std::sort(files.begin(), files.end());
+    } else {
+        files.push_back(path);
+    }
+    return files;
+}
+
+
+// Raw values of an integer (or timestamp) column widened to int64.
+void copy_integers(const arrow::Array& array, std::vector<int64_t>& out) {
+    out.resize(array.length());
+    switch (array.type_id()) {
+        case arrow::Type::INT64:
+        case arrow::Type::TIMESTAMP: {
+            const int64_t* values = array.data()->GetValues<int64_t>(1);
+            std::copy(values, values + array.length(), out.begin());
+            break;
+        }
+        case arrow::Type::INT32: {
+            const int32_t* values = array.data()->GetValues<int32_t>(1);
+            std::copy(values, values + array.length(), out.begin());
+            break;
+        }
+        default:
+            throw std::runtime_error("Unsupported column type: " + array.type()->ToString());
+    }
+}
+
+
+// Multiplier from the DateTime column's unit to ns.
+int64_t ns_per_unit(const arrow::DataType& type) {
+    if (type.id() != arrow::Type::TIMESTAMP) {
+        throw std::runtime_error("DateTime is not a timestamp column: " + type.ToString());
+    }
+    switch (static_cast<const arrow::TimestampType&>(type).unit()) {
+        case arrow::TimeUnit::SECOND: return 1000000000;
+        case arrow::TimeUnit::MILLI: return 1000000;
+        case arrow::TimeUnit::MICRO: return 1000;
+        case arrow::TimeUnit::NANO: return 1;
+    }
+    return 1;
+}
+
+
+// Row groups whose DateTime statistics overlap [from_ns, to_ns), every row group if the file has no statistics.
+std::vector<int> overlapping_row_groups(parquet::arrow::FileReader& reader, int64_t from_ns, int64_t to_ns, int64_t unit_ns) {
+    std::vector<int> row_groups;
+    auto metadata = reader.parquet_reader()->metadata();
+    const int leaf = metadata->schema()->ColumnIndex(TICK_COLUMN_NAMES[COL_DATETIME]);
+    for (int rg = 0; rg < metadata->num_row_groups(); ++rg) {
+        if (leaf >= 0) {
+            auto chunk = metadata->RowGroup(rg)->ColumnChunk(leaf);
+            auto stats = chunk->is_stats_set() ? chunk->statistics() : nullptr;
+            if (stats && stats->HasMinMax() && stats->physical_type() == parquet::Type::INT64) {
+                auto typed = std::static_pointer_cast<parquet::Int64Statistics>(stats);
+                if (typed->max() < from_ns / unit_ns || typed->min() > to_ns / unit_ns) {
+                    continue;
+                }
+            }
+        }
+        row_groups.push_back(rg);
+    }
+    return row_groups;
+}
+
+
+// Inserts the ticks of one Parquet file through the shared insert statement and returns the rows inserted.
+// A transaction is committed every options.commit_rows rows, pending_rows carries the count across files.
+int64_t load_file(const std::string& path, SQLite::Database& db, SQLite::Statement& insert,
+                  const LoaderOptions& options, int64_t& pending_rows) {
+    std::shared_ptr<arrow::io::ReadableFile> input;
+    PARQUET_ASSIGN_OR_THROW(input, arrow::io::ReadableFile::Open(path));
+    std::unique_ptr<parquet::arrow::FileReader> reader;
+    PARQUET_ASSIGN_OR_THROW(reader, parquet::arrow::OpenFile(input, arrow::default_memory_pool()));
+
+    std::shared_ptr<arrow::Schema> schema;
+    PARQUET_THROW_NOT_OK(reader->GetSchema(&schema));
+    std::vector<int> columns;
+    for (const char* name : TICK_COLUMN_NAMES) {
+        const int index = schema->GetFieldIndex(name);
+        if (index < 0) {
+            throw std::runtime_error("Parquet file " + path + " has no column " + name);
+        }
+        columns.push_back(index);
+    }
+
+    // --compact files store Price as int32 ticks of the tick size in the file metadata.
+    double tick_size = 0.0;
+    const auto& price_type = *schema->field(columns[COL_PRICE])->type();
+    if (price_type.id() == arrow::Type::INT32) {
+        auto value = schema->metadata() ? schema->metadata()->Get("tick_size") : arrow::Status::KeyError("tick_size");
+        if (!value.ok()) {
+            throw std::runtime_error("Parquet file " + path + " stores Price as ticks but has no tick_size metadata");
+        }
+        tick_size = std::stod(*value);
+    } else if (price_type.id() != arrow::Type::DOUBLE) {
+        throw std::runtime_error("Unsupported Price type in " + path + ": " + price_type.ToString());
+    }
+
+    const int64_t unit_ns = ns_per_unit(*schema->field(columns[COL_DATETIME])->type());
+    const std::vector<int> row_groups = overlapping_row_groups(*reader, options.from_ns, options.to_ns, unit_ns);
+    if (row_groups.empty()) {
+        return 0;
+    }
+
+    std::unique_ptr<arrow::RecordBatchReader> batches;
+    PARQUET_ASSIGN_OR_THROW(batches, reader->GetRecordBatchReader(row_groups, columns));
+
+    std::vector<int64_t> ids, times, asks, bids, price_ticks;
+    int64_t inserted = 0;
+    while (true) {
+        std::shared_ptr<arrow::RecordBatch> batch;
+        PARQUET_THROW_NOT_OK(batches->ReadNext(&batch));
+        if (!batch) {
+            break;
+        }
+        // The raw value buffers are copied below, a null slot has no value in them.
+        for (int c = 0; c < COL_COUNT; ++c) {
+            if (batch->column(c)->null_count() > 0) {
+                throw std::runtime_error("Parquet file " + path + " has nulls in column " + TICK_COLUMN_NAMES[c]);
+            }
+        }
+        copy_integers(*batch->column(COL_ID), ids);
+        copy_integers(*batch->column(COL_DATETIME), times);
+        copy_integers(*batch->column(COL_ASK), asks);
+        copy_integers(*batch->column(COL_BID), bids);
+        const double* prices = nullptr;
+        if (tick_size > 0.0) {
+            copy_integers(*batch->column(COL_PRICE), price_ticks);
+        } else {
+            prices = batch->column(COL_PRICE)->data()->GetValues<double>(1);
+        }
+
+        for (int64_t i = 0; i < batch->num_rows(); ++i) {
+            const int64_t time_ns = times[i] * unit_ns;
+            if (time_ns < options.from_ns || time_ns >= options.to_ns) {
+                continue;
+            }
+            insert.bind(1, static_cast<int64_t>(ids[i]));
+            insert.bind(2, format_timestamp(time_ns));
+            insert.bind(3, prices ? prices[i] : static_cast<double>(price_ticks[i]) * tick_size);
+            insert.bind(4, static_cast<int64_t>(asks[i]));
+            insert.bind(5, static_cast<int64_t>(bids[i]));
+            insert.exec();
+            insert.reset();
+            inserted++;
+
+            if (++pending_rows == options.commit_rows) {
+                db.exec("COMMIT");
+                db.exec("BEGIN");
+                pending_rows = 0;
+            }
+        }
+    }
+    return inserted;
+}
+
+
+// "YYYY-MM-DD" to ns since epoch of its midnight.
+bool parse_day(const std::string& text, int64_t& ns) {
+    return text.size() == 10 && parse_timestamp((text + " 00:00:00").c_str(), ns);
+}
+
+
+void print_usage(const char* program) {
+    std::cerr << "Usage: " << program << " <parquet_file_or_dataset> <db_path> <table_name> [options]\n"
+              << "Replaces <table_name> in <db_path> with the ticks of the Parquet file or of every .parquet file\n"
+              << "below the dataset directory, in the layout footprint_trainer reads.\n"
+              << "Options:\n"
+              << "  --from <YYYY-MM-DD>        first day loaded (default: everything)\n"
+              << "  --to <YYYY-MM-DD>          last day loaded, inclusive (default: everything)\n"
+              << "  --commit-rows <n>          rows inserted per transaction (default 1000000)\n"
+              << "  --no-index                 don't create the covering DateTime index after the load" << std::endl;
+}
+
+
+bool parse_options(int argc, char* argv[], LoaderOptions& options) {
+    try {
+        for (int i = 4; i < argc; ++i) {
+            const std::string arg(argv[i]);
+            const bool has_value = i + 1 < argc;
+            if (arg == "--from" && has_value) {
+                if (!parse_day(argv[++i], options.from_ns)) {
+                    std::cerr << "--from expects YYYY-MM-DD" << std::endl;
+                    return false;
+                }
+            } else if (arg == "--to" && has_value) {
+                if (!parse_day(argv[++i], options.to_ns)) {
+                    std::cerr << "--to expects YYYY-MM-DD" << std::endl;
+                    return false;
+                }
+                // the whole last day is loaded
+                options.to_ns += 86400LL * 1000000000LL;
+            } else if (arg == "--commit-rows" && has_value) {
+                options.commit_rows = std::stoll(argv[++i]);
+            } else if (arg == "--no-index") {
+                options.create_index = false;
+            } else {
+                std::cerr << "Unknown option: " << arg << std::endl;
+                return false;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Invalid option value: " << e.what() << std::endl;
+        return false;
+    }
+
+    if (options.commit_rows <= 0) {
+        std::cerr << "--commit-rows must be positive" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+
+int main(int argc, char* argv[]) {
+    if (argc < 4) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    const std::string input_path(argv[1]);
+    const std::string db_path(argv[2]);
+    const std::string table_name(argv[3]);
+
+    LoaderOptions options;
+    if (!parse_options(argc, argv, options)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    try {
+        const std::vector<std::string> files = parquet_files(input_path);
+        if (files.empty()) {
+            throw std::runtime_error("No .parquet files found in " + input_path);
+        }
+
+        SQLite::Database db(db_path, SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE);
+        db.exec(LOAD_PRAGMAS);
+
+        const std::string quoted = "\"" + table_name + "\"";
+        db.exec("DROP TABLE IF EXISTS " + quoted);
+        db.exec("CREATE TABLE " + quoted + " (id INTEGER, DateTime TEXT, Price REAL, AskVolume INTEGER, BidVolume INTEGER)");
+
+        // One statement for the whole load, every row only rebinds its five parameters.
+        SQLite::Statement insert(db, "INSERT INTO " + quoted + " (id, DateTime, Price, AskVolume, BidVolume) VALUES (?, ?, ?, ?, ?)");
+
+        int64_t total_rows = 0;
+        int64_t pending_rows = 0;
+        db.exec("BEGIN");
+        for (const auto& file : files) {
+            total_rows += load_file(file, db, insert, options, pending_rows);
+        }
+        db.exec("COMMIT");
+        std::cout << "Loaded " << total_rows << " ticks from " << files.size() << " file(s) into " << table_name << std::endl;
+
+        // Built once over the sorted data instead of being maintained on every insert.
+        // Same covering index as SqliteTickSource::createDateTimeIndex, so footprint_trainer uses it as is.
+        if (options.create_index) {
+            db.exec("CREATE INDEX \"idx_" + table_name + "_DateTime\" ON " + quoted +
+                    " (DateTime, id, Price, AskVolume, BidVolume)");
+            std::cout << "Created the DateTime index." << std::endl;
+        }
+
+    } catch (const std::exception& e) {
+        std::cerr << "Critical Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
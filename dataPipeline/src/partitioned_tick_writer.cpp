@@ -0,0 +1,101 @@
+#include "partitioned_tick_writer.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+
+#include "timestamps.h"
+
+namespace {
+
+constexpr int64_t NS_PER_MINUTE = 60LL * 1000000000LL;
+constexpr int64_t NS_PER_DAY = 1440 * NS_PER_MINUTE;
+
+int64_t epoch_day(int64_t ns) {
+    int64_t day = ns / NS_PER_DAY;
+    return (ns % NS_PER_DAY < 0) ? day - 1 : day;
+}
+
+} // namespace
+
+
+PartitionedTickWriter::PartitionedTickWriter(const std::string& root, const ParquetWriterOptions& options, int session_start_minutes,
+                                             const DatasetManifest& previous)
+    : root(root),
+      options(options),
+      session_shift_ns(session_start_minutes == 0 ? 0 : NS_PER_DAY - session_start_minutes * NS_PER_MINUTE),
+      manifest(previous) {
+    for (const auto& partition : previous.partitions) {
+        files_per_directory[partition.path.substr(0, partition.path.rfind('/'))]++;
+    }
+}
+
+
+void PartitionedTickWriter::set_watermark(const std::string& table_name, int64_t last_id, int64_t last_time_ns) {
+    manifest.set_watermark(table_name, last_id, last_time_ns);
+}
+
+
+void PartitionedTickWriter::append(int64_t id, int64_t date_time_ns, double price, int64_t ask_volume, int64_t bid_volume) {
+    const int64_t day = epoch_day(date_time_ns + session_shift_ns);
+    if (!current || day != current_day) {
+        open_partition(day);
+    }
+    current->append(id, date_time_ns, price, ask_volume, bid_volume);
+    row_count++;
+
+    if (current_stats.rows == 0) {
+        current_stats.min_id = current_stats.max_id = id;
+        current_stats.min_time_ns = current_stats.max_time_ns = date_time_ns;
+    } else {
+        current_stats.min_id = std::min(current_stats.min_id, id);
+        current_stats.max_id = std::max(current_stats.max_id, id);
+        current_stats.min_time_ns = std::min(current_stats.min_time_ns, date_time_ns);
+        current_stats.max_time_ns = std::max(current_stats.max_time_ns, date_time_ns);
+    }
+    current_stats.rows++;
+}
+
+
+void PartitionedTickWriter::close() {
+    close_partition();
+    write_manifest(root, manifest);
+}
+
+
+void PartitionedTickWriter::close_partition() {
+    if (current) {
+        current->close();
+        current.reset();
+        manifest.partitions.push_back(current_stats);
+    }
+}
+
+
+void PartitionedTickWriter::open_partition(int64_t session_day) {
+    close_partition();
+
+    int year;
+    unsigned month, day;
+    civil_from_days(session_day, year, month, day);
+    char directory[64];
+    std::snprintf(directory, sizeof(directory), "year=%04d/month=%02u/day=%02u", year, month, day);
+
+    const std::filesystem::path path = std::filesystem::path(root) / directory;
+    std::filesystem::create_directories(path);
+
+    const int file_index = files_per_directory[directory]++;
+    // later files of a session sort after data.parquet and in the order they were written
+    char file_name[32];
+    if (file_index == 0) {
+        std::snprintf(file_name, sizeof(file_name), "data.parquet");
+    } else {
+        std::snprintf(file_name, sizeof(file_name), "data_%04d.parquet", file_index);
+    }
+    file_count++;
+
+    current = std::make_unique<ParquetTickWriter>((path / file_name).string(), options);
+    current_day = session_day;
+    current_stats = ManifestPartition();
+    current_stats.path = std::string(directory) + "/" + file_name;
+}
@@ -0,0 +1,57 @@
+#ifndef PARTITIONED_TICK_WRITER_H
+#define PARTITIONED_TICK_WRITER_H
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+
+#include "manifest.h"
+#include "parquet_tick_writer.h"
+
+// Streams ticks into a Hive style day partitioned dataset:
+// <root>/year=YYYY/month=MM/day=DD/data.parquet, one directory per trading session.
+// A session starts at session_start_minutes past New York midnight and is named after the calendar
+// day it ends on, so with the default of 0 a partition is a New York calendar day and with 18:00 the
+// evening ticks go to the next day's partition.
+// The file of a session is closed as soon as a tick of another session arrives, so only one file is open
+// at a time. Should an already closed session come back, its ticks go to an additional data_<nnnn>.parquet
+// in the same directory. close() writes the _manifest of the partitions written.
+// A writer that continues an existing dataset (--incremental) starts from its manifest: earlier files are
+// kept, sessions that already have files get the next data_<nnnn>.parquet, and the manifest is extended.
+class PartitionedTickWriter {
+public:
+    PartitionedTickWriter(const std::string& root, const ParquetWriterOptions& options, int session_start_minutes = 0,
+                          const DatasetManifest& previous = DatasetManifest());
+
+    // date_time_ns is the New York local time as ns since epoch, it selects the partition.
+    void append(int64_t id, int64_t date_time_ns, double price, int64_t ask_volume, int64_t bid_volume);
+
+    // Records how far the given source table has been written, stored in the manifest by close().
+    void set_watermark(const std::string& table_name, int64_t last_id, int64_t last_time_ns);
+
+    // Closes the open partition and writes <root>/_manifest.
+    void close();
+
+    int64_t rows() const { return row_count; }
+    int64_t files() const { return file_count; }
+
+private:
+    void close_partition();
+    void open_partition(int64_t session_day);
+
+    std::string root;
+    ParquetWriterOptions options;
+    int64_t session_shift_ns;   // added to a tick's time so a session falls on a single calendar day
+
+    std::unique_ptr<ParquetTickWriter> current;
+    int64_t current_day = 0;
+    ManifestPartition current_stats;
+    std::map<std::string, int> files_per_directory;
+    DatasetManifest manifest;
+
+    int64_t row_count = 0;
+    int64_t file_count = 0;
+};
+
+#endif // PARTITIONED_TICK_WRITER_H
@@ -0,0 +1,56 @@
+#include "roll_map.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <stdexcept>
+
+std::vector<RollRun> build_roll_map(SQLite::Database& db, const std::vector<std::string>& table_names,
+                                    const std::vector<RollRun>& pinned) {
+    struct DayChoice {
+        size_t table = 0;
+        int64_t volume = -1;
+    };
+    // "YYYY/MM/DD" sorts chronologically as text
+    std::map<std::string, DayChoice> dominant;
+
+    for (size_t t = 0; t < table_names.size(); ++t) {
+        // The aggregation runs inside SQLite, only one row per day comes back.
+        SQLite::Statement query(db, "SELECT \"Date\", SUM(\"Volume\") FROM \"" + table_names[t] + "\" GROUP BY \"Date\"");
+        while (query.executeStep()) {
+            const int64_t volume = query.getColumn(1).getInt64();
+            DayChoice& choice = dominant[query.getColumn(0).getString()];
+            if (volume > choice.volume) {
+                choice.table = t;
+                choice.volume = volume;
+            }
+        }
+    }
+
+    // Both the days and the pinned runs are in date order, so one pass assigns every pinned day.
+    auto pin = pinned.begin();
+    for (auto& [date, choice] : dominant) {
+        while (pin != pinned.end() && pin->last_date < date) {
+            ++pin;
+        }
+        if (pin == pinned.end() || date < pin->first_date) {
+            continue;
+        }
+        const auto table = std::find(table_names.begin(), table_names.end(), pin->table_name);
+        if (table == table_names.end()) {
+            throw std::runtime_error("Roll map day " + date + " was written from table " + pin->table_name +
+                                     ", which is not being converted");
+        }
+        choice.table = static_cast<size_t>(table - table_names.begin());
+    }
+
+    std::vector<RollRun> runs;
+    for (const auto& [date, choice] : dominant) {
+        if (runs.empty() || runs.back().table_name != table_names[choice.table]) {
+            runs.push_back({table_names[choice.table], date, date, 0});
+        }
+        runs.back().last_date = date;
+        runs.back().days++;
+    }
+    return runs;
+}
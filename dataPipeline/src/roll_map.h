@@ -0,0 +1,25 @@
+#ifndef ROLL_MAP_H
+#define ROLL_MAP_H
+
+#include <string>
+#include <vector>
+
+#include <SQLiteCpp/SQLiteCpp.h>
+
+// Consecutive roll map days that are all taken from the same contract table.
+// Dates are the raw "YYYY/MM/DD" values of the Date column, first_date and last_date are inclusive.
+struct RollRun {
+    std::string table_name;
+    std::string first_date;
+    std::string last_date;
+    int days = 0;
+};
+
+// Picks the contract with the highest traded volume for every day, with one GROUP BY "Date" query
+// per table, and returns the choice as chronological runs. On equal volume the earlier table wins.
+// Days inside one of the chronological `pinned` runs keep that run's table whatever the volumes say,
+// --incremental pins the days an earlier run already wrote. Throws if a pinned table is not in table_names.
+std::vector<RollRun> build_roll_map(SQLite::Database& db, const std::vector<std::string>& table_names,
+                                    const std::vector<RollRun>& pinned = {});
+
+#endif // ROLL_MAP_H
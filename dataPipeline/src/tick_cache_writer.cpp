@@ -0,0 +1,126 @@
+#include "tick_cache_writer.h"
+
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+
+// Records are written in blocks of this many ticks.
+constexpr size_t WRITE_BUFFER_RECORDS = 1 << 16;
+
+// Records start at the first 8 byte boundary after the header so the mapped file can be read in place.
+constexpr uint64_t RECORDS_OFFSET = (sizeof(TickCacheHeader) + 7) / 8 * 8;
+
+int64_t epoch_day(int64_t ns) {
+    int64_t day = ns / TICK_CACHE_NS_PER_DAY;
+    return (ns % TICK_CACHE_NS_PER_DAY < 0) ? day - 1 : day;
+}
+
+TickCacheHeader make_header(double tick_size, uint64_t record_count, uint64_t day_count) {
+    TickCacheHeader header = {};
+    std::memcpy(header.magic, TICK_CACHE_MAGIC, sizeof(header.magic));
+    header.version = TICK_CACHE_VERSION;
+    header.recordSize = sizeof(TickCacheRecord);
+    header.tickSize = tick_size;
+    header.recordCount = record_count;
+    header.dayCount = day_count;
+    header.recordsOffset = RECORDS_OFFSET;
+    header.indexOffset = RECORDS_OFFSET + record_count * sizeof(TickCacheRecord);
+    return header;
+}
+
+} // namespace
+
+
+TickCacheWriter::TickCacheWriter(const std::string& path, double tick_size)
+    : path(path), out(path, std::ios::binary | std::ios::trunc), tick_size(tick_size) {
+    if (!out) {
+        throw std::runtime_error("Can't create tick cache: " + path);
+    }
+    // Placeholder header, rewritten with the final counts by finish().
+    const TickCacheHeader header = make_header(tick_size, 0, 0);
+    const char padding[RECORDS_OFFSET - sizeof(TickCacheHeader) + 1] = {};
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(padding, RECORDS_OFFSET - sizeof(TickCacheHeader));
+    buffer.reserve(WRITE_BUFFER_RECORDS);
+}
+
+
+TickCacheWriter::~TickCacheWriter() {
+    if (!finished && !failed) {
+        abandon("not finished");
+    }
+}
+
+
+bool TickCacheWriter::append(int64_t date_time_ns, double price, int64_t ask_volume, int64_t bid_volume, int64_t id) {
+    if (failed) {
+        return false;
+    }
+
+    const int64_t day = epoch_day(date_time_ns);
+    if (days.empty() || days.back().epochDay != day) {
+        if (!days.empty() && day < days.back().epochDay) {
+            abandon("ticks are not in day order");
+            return false;
+        }
+        days.push_back({day, record_count, 0});
+    }
+    days.back().count++;
+
+    TickCacheRecord record;
+    record.dateTimeNs = date_time_ns;
+    record.priceTicks = static_cast<int32_t>(std::llround(price / tick_size));
+    record.askVolume = static_cast<int32_t>(ask_volume);
+    record.bidVolume = static_cast<int32_t>(bid_volume);
+    record.id = static_cast<int32_t>(id);
+    buffer.push_back(record);
+    record_count++;
+
+    if (buffer.size() == WRITE_BUFFER_RECORDS) {
+        flush();
+    }
+    return !failed;
+}
+
+
+bool TickCacheWriter::finish() {
+    if (failed) {
+        return false;
+    }
+    flush();
+    out.write(reinterpret_cast<const char*>(days.data()), days.size() * sizeof(TickCacheDay));
+
+    const TickCacheHeader header = make_header(tick_size, record_count, days.size());
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.close();
+    if (!out) {
+        abandon("write failed");
+        return false;
+    }
+    finished = true;
+    return true;
+}
+
+
+void TickCacheWriter::flush() {
+    out.write(reinterpret_cast<const char*>(buffer.data()), buffer.size() * sizeof(TickCacheRecord));
+    buffer.clear();
+    if (!out) {
+        abandon("write failed");
+    }
+}
+
+
+void TickCacheWriter::abandon(const std::string& reason) {
+    std::cerr << "Warning: Abandoning tick cache " << path << ": " << reason << std::endl;
+    failed = true;
+    buffer.clear();
+    out.close();
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+}
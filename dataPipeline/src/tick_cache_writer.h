@@ -0,0 +1,43 @@
+#ifndef TICK_CACHE_WRITER_H
+#define TICK_CACHE_WRITER_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "tick_cache_format.h"
+
+// Writes one contract table as a flat binary tick cache (see tick_cache_format.h) that
+// footprint_trainer memory maps instead of querying SQLite or decoding Parquet.
+// Ticks must arrive day by day; a tick whose day is older than the previous one abandons the cache.
+class TickCacheWriter {
+public:
+    TickCacheWriter(const std::string& path, double tick_size);
+    ~TickCacheWriter();
+
+    TickCacheWriter(const TickCacheWriter&) = delete;
+    TickCacheWriter& operator=(const TickCacheWriter&) = delete;
+
+    // Appends one tick, date_time_ns is the New York local time as ns since epoch.
+    // Returns false once the cache has been abandoned.
+    bool append(int64_t date_time_ns, double price, int64_t ask_volume, int64_t bid_volume, int64_t id);
+
+    // Writes the day index and the final header. Returns false if the cache was abandoned.
+    bool finish();
+
+private:
+    void flush();
+    void abandon(const std::string& reason);
+
+    std::string path;
+    std::ofstream out;
+    double tick_size;
+    std::vector<TickCacheRecord> buffer;
+    std::vector<TickCacheDay> days;
+    uint64_t record_count = 0;
+    bool failed = false;
+    bool finished = false;
+};
+
+#endif // TICK_CACHE_WRITER_H
@@ -0,0 +1,174 @@
+#include "timestamps.h"
+
+#include <chrono>
+#include <cstdio>
+#include <limits>
+
+namespace {
+
+constexpr int64_t NS_PER_SECOND = 1000000000LL;
+
+// Days since 1970-01-01 of a proleptic Gregorian date (Howard Hinnant's days_from_civil).
+int64_t days_from_civil(int64_t y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    const int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = static_cast<unsigned>(y - era * 400);
+    const unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<int64_t>(doe) - 719468;
+}
+
+// Reads between min_width and max_width digits, advancing text. Returns false if there are fewer.
+// Fields are normally zero padded, the short form is accepted like date::parse does.
+bool read_digits(const char*& text, int min_width, int max_width, int& value) {
+    value = 0;
+    int width = 0;
+    while (width < max_width) {
+        const unsigned digit = static_cast<unsigned char>(text[width]) - '0';
+        if (digit > 9) {
+            break;
+        }
+        value = value * 10 + static_cast<int>(digit);
+        ++width;
+    }
+    text += width;
+    return width >= min_width;
+}
+
+bool read_separator(const char*& text, char separator) {
+    if (*text != separator) {
+        return false;
+    }
+    ++text;
+    return true;
+}
+
+int64_t floor_seconds(int64_t ns) {
+    return (ns >= 0 ? ns : ns - (NS_PER_SECOND - 1)) / NS_PER_SECOND;
+}
+
+// Period bounds of the tz database reach far past what int64 ns can hold, clamp them.
+int64_t clamped_ns(date::sys_seconds time) {
+    const int64_t seconds = time.time_since_epoch().count();
+    if (seconds >= std::numeric_limits<int64_t>::max() / NS_PER_SECOND) {
+        return std::numeric_limits<int64_t>::max();
+    }
+    if (seconds <= std::numeric_limits<int64_t>::min() / NS_PER_SECOND) {
+        return std::numeric_limits<int64_t>::min();
+    }
+    return seconds * NS_PER_SECOND;
+}
+
+// Reads "YYYY<separator>MM<separator>DD" as days since epoch, advancing text.
+bool read_date(const char*& text, char separator, int64_t& days) {
+    int year, month, day;
+    if (!read_digits(text, 4, 4, year) || !read_separator(text, separator) ||
+        !read_digits(text, 1, 2, month) || !read_separator(text, separator) ||
+        !read_digits(text, 1, 2, day)) {
+        return false;
+    }
+    if (month < 1 || month > 12 || day < 1 || day > 31) {
+        return false;
+    }
+    days = days_from_civil(year, month, day);
+    return true;
+}
+
+// Reads "HH:MM:SS" with an optional fraction of a second as ns since midnight, advancing text.
+bool read_time(const char*& text, int64_t& ns) {
+    int hour, minute, second;
+    if (!read_digits(text, 1, 2, hour) || !read_separator(text, ':') ||
+        !read_digits(text, 1, 2, minute) || !read_separator(text, ':') ||
+        !read_digits(text, 1, 2, second)) {
+        return false;
+    }
+    if (hour > 23 || minute > 59 || second > 60) {
+        return false;
+    }
+
+    // optional fraction of a second, digits past ns are dropped
+    int64_t fraction_ns = 0;
+    if (*text == '.') {
+        ++text;
+        int64_t scale = NS_PER_SECOND;
+        while (*text >= '0' && *text <= '9') {
+            if (scale > 1) {
+                scale /= 10;
+                fraction_ns += (*text - '0') * scale;
+            }
+            ++text;
+        }
+    }
+    ns = (hour * 3600LL + minute * 60 + second) * NS_PER_SECOND + fraction_ns;
+    return true;
+}
+
+} // namespace
+
+
+bool parse_utc_timestamp(const char* date_text, const char* time_text, int64_t& utc_ns) {
+    int64_t days, time_ns;
+    if (!read_date(date_text, '/', days) || *date_text != '\0' ||
+        !read_time(time_text, time_ns) || *time_text != '\0') {
+        return false;
+    }
+    utc_ns = days * 86400 * NS_PER_SECOND + time_ns;
+    return true;
+}
+
+
+bool parse_timestamp(const char* text, int64_t& ns) {
+    int64_t days, time_ns;
+    if (!read_date(text, '-', days) || !read_separator(text, ' ') ||
+        !read_time(text, time_ns) || *text != '\0') {
+        return false;
+    }
+    ns = days * 86400 * NS_PER_SECOND + time_ns;
+    return true;
+}
+
+
+std::string format_timestamp(int64_t ns) {
+    const int64_t seconds = floor_seconds(ns);
+    const int64_t fraction = ns - seconds * NS_PER_SECOND;
+    const int64_t days = (seconds >= 0 ? seconds : seconds - 86399) / 86400;
+    const int64_t second_of_day = seconds - days * 86400;
+
+    int year;
+    unsigned month, day;
+    civil_from_days(days, year, month, day);
+    char text[64];
+    std::snprintf(text, sizeof(text), "%04d-%02u-%02u %02d:%02d:%02d.%09lld", year, month, day,
+                  static_cast<int>(second_of_day / 3600), static_cast<int>(second_of_day / 60 % 60),
+                  static_cast<int>(second_of_day % 60), static_cast<long long>(fraction));
+    return text;
+}
+
+
+void civil_from_days(int64_t days, int& year, unsigned& month, unsigned& day) {
+    days += 719468;
+    const int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    const unsigned doe = static_cast<unsigned>(days - era * 146097);
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp = (5 * doy + 2) / 153;
+    day = doy - (153 * mp + 2) / 5 + 1;
+    month = mp < 10 ? mp + 3 : mp - 9;
+    year = static_cast<int>(static_cast<int64_t>(yoe) + era * 400 + (month <= 2));
+}
+
+
+NewYorkClock::NewYorkClock() : zone(date::locate_zone("America/New_York")) {}
+
+
+int64_t NewYorkClock::to_local_ns(int64_t utc_ns) {
+    if (utc_ns < period_begin_ns || utc_ns >= period_end_ns) {
+        using namespace std::chrono;
+        const date::sys_seconds utc_seconds{seconds(floor_seconds(utc_ns))};
+        const date::sys_info info = zone->get_info(utc_seconds);
+        period_begin_ns = clamped_ns(info.begin);
+        period_end_ns = clamped_ns(info.end);
+        offset_ns = duration_cast<nanoseconds>(info.offset).count();
+    }
+    return utc_ns + offset_ns;
+}
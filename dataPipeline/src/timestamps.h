@@ -0,0 +1,39 @@
+#ifndef TIMESTAMPS_H
+#define TIMESTAMPS_H
+
+#include <cstdint>
+#include <string>
+
+#include "date/tz.h"
+
+// Parses the export columns "YYYY/MM/DD" and "HH:MM:SS" (optionally "HH:MM:SS.fff...")
+// into ns since epoch. Returns false if either field doesn't match the fixed format.
+bool parse_utc_timestamp(const char* date_text, const char* time_text, int64_t& utc_ns);
+
+// Parses format_timestamp's "YYYY-MM-DD HH:MM:SS[.nnnnnnnnn]" back into ns since epoch.
+bool parse_timestamp(const char* text, int64_t& ns);
+
+// "YYYY-MM-DD HH:MM:SS.nnnnnnnnn" of ns since epoch.
+std::string format_timestamp(int64_t ns);
+
+// Calendar date of a day count since 1970-01-01.
+void civil_from_days(int64_t days, int& year, unsigned& month, unsigned& day);
+
+// Converts UTC to New York local time.
+// The UTC offset of the current DST period is cached, the tz database is only asked again
+// once a timestamp falls outside that period, i.e. at DST transitions.
+class NewYorkClock {
+public:
+    NewYorkClock();
+
+    // ns since epoch of the (timezone naive) New York local time.
+    int64_t to_local_ns(int64_t utc_ns);
+
+private:
+    const date::time_zone* zone;
+    int64_t period_begin_ns = 0;
+    int64_t period_end_ns = 0;   // the cached offset is valid for [period_begin_ns, period_end_ns)
+    int64_t offset_ns = 0;
+};
+
+#endif // TIMESTAMPS_H
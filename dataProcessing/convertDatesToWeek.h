@@ -6,5 +6,8 @@
 
 // Function declaration
 std::vector<weekVector> convertDatesToWeeks(Date startDate, Date endDate);
+Date addDay(Date date);
+bool operator<=(const Date &a, const Date &b);
+bool operator<(const Date &a, const Date &b);
 
 #endif // CONVERTDATESTOWEEK_H
@@ -7,9 +7,20 @@
 #include <ctime>
 #include <array>
 #include <cmath>
+#include <cstdint>
 
+#include "instrumentSpec.h"
+#include "volumeProfile.h"
+#include "sessionProfiles.h"
+#include "rollingWindow.h"
 
 
+// finished sessions in the composite profile of a day
+constexpr size_t COMPOSITE_SESSIONS = 5;
+
+// sentinel for a bar time that is not set yet (exported as "-1")
+constexpr int64_t NO_TIME = -1;
+
 // Define a simple Date type and week container
 struct Date {
 	int y, m, d;
@@ -39,48 +50,125 @@ struct PriceLevel {
     double imbAtPrice = 0.0;
     double imbAtUpperPrice = 0.0;
     double imbAtLowerPrice = 0.0;
+    bool isTraded = false; // a tick printed at this price, gaps inside the ladder stay false
+
+};
 
+
+// contiguous price levels of one bar indexed by tick, from the lowest to the highest traded tick
+// a range bar only spans a handful of ticks, so a level is a plain index instead of a tree lookup,
+// the ladder grows at either end when price leaves the current range.
+// slots between traded prices exist with zero volume but are not levels of the footprint (isTraded is false),
+// size(), find() and forEachLevel() only see traded levels
+class PriceLadder {
+public:
+    // level at tick, marked as traded. the ladder is extended to cover it
+    PriceLevel& trade(int32_t tick) {
+        PriceLevel& level = slot(tick);
+        if (!level.isTraded) {
+            level.isTraded = true;
+            ++tradedCount;
+        }
+        return level;
+    }
+
+    // level at tick inside [lowTick(), highTick()], traded or not
+    PriceLevel& at(int32_t tick) { return levels[tick - firstTick]; }
+    const PriceLevel& at(int32_t tick) const { return levels[tick - firstTick]; }
+
+    // traded level at tick, nullptr if nothing printed there
+    const PriceLevel* find(int32_t tick) const {
+        if (tick < firstTick || tick > highTick() || !levels[tick - firstTick].isTraded) {
+            return nullptr;
+        }
+        return &levels[tick - firstTick];
+    }
+
+    bool empty() const { return tradedCount == 0; }
+    size_t size() const { return tradedCount; }   // traded levels
+    int32_t lowTick() const { return firstTick; }
+    int32_t highTick() const { return firstTick + static_cast<int32_t>(levels.size()) - 1; }
+
+    // calls f(tick, level) for every traded level from the lowest price up
+    template <typename F>
+    void forEachLevel(F&& f) const {
+        for (size_t i = 0; i < levels.size(); ++i) {
+            if (levels[i].isTraded) {
+                f(firstTick + static_cast<int32_t>(i), levels[i]);
+            }
+        }
+    }
+
+private:
+    PriceLevel& slot(int32_t tick) {
+        if (levels.empty()) {
+            levels.reserve(16);
+            levels.emplace_back();
+            firstTick = tick;
+        } else if (tick < firstTick) {
+            levels.insert(levels.begin(), firstTick - tick, PriceLevel());
+            firstTick = tick;
+        } else if (tick > highTick()) {
+            levels.resize(tick - firstTick + 1);
+        }
+        return levels[tick - firstTick];
+    }
+
+    std::vector<PriceLevel> levels;
+    int32_t firstTick = 0;
+    size_t tradedCount = 0;
 };
 
 
 // footprint data for the bar
 // updtion will be at each tick iteration
 struct Footprint {
-    std::map<double, PriceLevel> priceLevels;  // Time-based volume information
+    PriceLadder priceLevels;  // volume information per traded price
 };
 
 
 
 // bar data structure stores the data that can a single bar will hold within the whole cahrt data
+// only the fields the per tick path touches live here (about two cache lines), the price relative features
+// of the bar are kept in a separate BarFeatures block, see Day::barFeatures
 // updation will occur at different frequency based on the calculations
 struct Bar {
 // calculated at each tick iteration
-    Footprint footprint; // Footprint data of the bar
-    int buyImbalanceCount = 0; // Number of imbalances detected in the bar
-    int sellImbalanceCount = 0; // Number of imbalances detected in the bar
+    // bar's basic OHLCV data, prices in ticks of the contract's InstrumentSpec
+    int32_t openTicks = 0;     // Opening price
+    int32_t closeTicks = 0;    // Closing price
+    int32_t highTicks = 0;     // Highest price
+    int32_t lowTicks = 0;      // Lowest price
+    int barTotalVolume = 0;       // Total traded volume
+
+    // footprint matrics
     int delta = 0; // Net volume delta (buy volume - sell volume)
+    int cumDeltaAtBar = 0; // cumulative delta at the bar level for the day
     int barDeltaChange = 0; // Change in delta from the previous bar
     int barHighDelta = 0; // delta of the top two price levels in the bar
     int barLowDelta = 0; // delta of the bottom two price levels in the bar
-    double barPOCPrice = 0.0; // Point of Control price level in the bar
+    int buyImbalanceCount = 0; // Number of imbalances detected in the bar
+    int sellImbalanceCount = 0; // Number of imbalances detected in the bar
+    int32_t barPOCTicks = 0; // Point of Control price level in the bar (ticks)
     int barPOCVol = 0; // Volume at the Point of Control price level in the bar
+    Footprint footprint; // Footprint data of the bar
+
+    int64_t startTime = NO_TIME;          // Start time of the bar (ns since epoch)
+    int64_t endTime = NO_TIME;            // End time of the bar (ns since epoch)
 
-    // bar's basic OHLCV data and will be calculated at each tick iteration
-    std::string startTime = "-1";          // Start time of the bar
-    std::string endTime = "-1";            // End time of the bar
-    double open = 0.0;         // Opening price
-    double close = 0.0;        // Closing price
-    double high = 0.0;         // Highest price
-    double low = 0.0;          // Lowest price
-    int barTotalVolume = 0;       // Total traded volume
-    
 // signal related data for the bar, will be updated once when signal is generated
 // if signal will checked with many fixed set of rules(like minVolume, imbalance threshhold and etc) at each tick only if the signalStatus is false
 // only one signal per candle
     int signal = 0;       // Trading signal for the bar (2 for buy, 1 for sell, 0 for neutral)
     int signalID = -1;     // Unique identifier for the signal, is the index of the tick when the signal was generated from the raw data, -1 if no signal
     bool signalStatus = false; // true if the signal is alresdy generated for the bar, false otherwise
-    
+
+};
+
+
+// price relative features of a bar, the cold part of the bar record
+// written by updatePriceSensitiveFeatures and read by the exporters, the per tick path never touches it
+struct BarFeatures {
 // price-indicators difference value for the bar, will be calculated only if price changed
     double priceCurrentDayVwapDiff = 0.0;      // Difference between last price and current day underdeveloping VWAP
     double priceCurrentDayVwapUpperStdDev1Diff = 0.0; // Difference between last price and Day VWAP + 1 Std Dev
@@ -119,13 +207,50 @@ struct Bar {
     double priceLastSwingLowDiff = 0.0;  // Difference between last price and last swing low
     double priceLastHVNDiff = 0.0;      // Difference between last price and last high volume node
 
-// extras for calculations
-    int cumDeltaAtBar = 0; // cumulative delta at the bar level for the day
+};
 
+
+// columnar history of the completed bars of a day, one contiguous array per field the indicator kernels scan.
+// a Bar record is several hundred bytes, so lookback loops over Day::bars stride over a cache line or more per value,
+// the columns keep those loops dense (and vectorizable) and a columnar exporter can copy them as they are.
+// a bar is appended once, when it is closed (the last bar of the day when the day is finished)
+struct BarColumns {
+    std::vector<int32_t> openTicks;
+    std::vector<int32_t> highTicks;
+    std::vector<int32_t> lowTicks;
+    std::vector<int32_t> closeTicks;
+    std::vector<int> volume;          // barTotalVolume
+    std::vector<int> delta;
+    std::vector<int> cumDeltaAtBar;
+
+    size_t size() const { return closeTicks.size(); }
+
+    void append(const Bar& bar) {
+        openTicks.push_back(bar.openTicks);
+        highTicks.push_back(bar.highTicks);
+        lowTicks.push_back(bar.lowTicks);
+        closeTicks.push_back(bar.closeTicks);
+        volume.push_back(bar.barTotalVolume);
+        delta.push_back(bar.delta);
+        cumDeltaAtBar.push_back(bar.cumDeltaAtBar);
+    }
+};
+
+// rolling regressions of the closed bars' close (ticks) and cumulative delta for one divergence lookback,
+// the lookback's last point is the live bar, so the windows keep lookbackBars - 1 closed bars
+struct DivergenceWindow {
+    explicit DivergenceWindow(int lookbackBars)
+        : lookbackBars(lookbackBars), price(static_cast<size_t>(lookbackBars - 1)), cumDelta(static_cast<size_t>(lookbackBars - 1)) {}
+
+    int lookbackBars;
+    RollingLinearRegression<RUNTIME_WINDOW> price;
+    RollingLinearRegression<RUNTIME_WINDOW> cumDelta;
 };
 
 struct Day {
     std::vector<Bar> bars;
+    std::vector<BarFeatures> barFeatures; // cold price features of bars[i], one entry per bar
+    BarColumns closedBars; // completed bars of `bars` in columns, all but the live last bar while the day runs, every bar once it is finished
     std::string dayOfTheWeek = "-1"; 
 
 // footprint related calculation
@@ -133,6 +258,8 @@ struct Day {
     double cumDelta5barSlope = 0.0; // Slope of cumulative delta over the last 5 bars
     double priceCumDeltaDivergence5bar = 0.0; // Price and cumulative delta divergence measure
     double priceCumDeltaDivergence10bar = 0.0; // Price and cumulative delta divergence measure
+    double priceCumDeltaDivergence20bar = 0.0; // Price and cumulative delta divergence measure
+    double priceCumDeltaDivergence50bar = 0.0; // Price and cumulative delta divergence measure
     double interactionReversal = 0.0; // Interaction reversal measure
     double interactionReversal20barAvg = 0.0; // Interaction reversal measure over the last 20 bars
 
@@ -148,41 +275,52 @@ struct Day {
     double bbLower = 0.0; // Lower Bollinger Band for the day
     double BBandWidth = 0.0;                     // Width of the Bollinger Bands
     double rsi = 0.0; // Relative Strength Index for the day
-    double poc = 0.0; // Point of Control for the day
-    double vah = 0.0; // Value Area High for the day
-    double val = 0.0; // Value Area Low for the day
+    VolumeProfile profile; // volume of every tick of the day, fed by updateFootprint
+    int32_t pocTicks = 0; // Point of Control for the day
+    int32_t vahTicks = 0; // Value Area High for the day
+    int32_t valTicks = 0; // Value Area Low for the day
 
 //calculated once 
-    double ibHigh = 0.0; // Initial Balance High for the day , calculated for the first hour
-    double ibLow = 0.0; // Initial Balance Low for the day, calculated for the first hour
+    // composite profile of the sessions finished before this day (the last COMPOSITE_SESSIONS of them), 0 without any
+    int32_t compositePocTicks = 0;
+    int32_t compositeVahTicks = 0;
+    int32_t compositeValTicks = 0;
+    int32_t ibHighTicks = 0; // Initial Balance High for the day , calculated for the first hour
+    int32_t ibLowTicks = 0; // Initial Balance Low for the day, calculated for the first hour
 //calculated on bar update
-    double dayHigh = 0.0; // Highest price of the day calculated at the end of the day
-    double dayLow = 0.0; // Lowest price of the day calculated at the end of the day
-    double dayClose = 0.0; // Closing price of the day calculated at the end of the day
+    int32_t dayHighTicks = 0; // Highest price of the day calculated at the end of the day
+    int32_t dayLowTicks = 0; // Lowest price of the day calculated at the end of the day
+    int32_t dayCloseTicks = 0; // Closing price of the day calculated at the end of the day
 
     int64_t totalVolume = 0; // Total volume traded during the day will be calculated during the vwap calculation
     int cumulativeDelta = 0; // Cumulative delta for the day
-    double lastSwingHigh = 0.0; // Last swing high price of the day calculated at bar update
-    double lastSwingLow = 0.0; // Last swing low price of the day calculated at bar update
-    double lastHighVolumeNode = 0.0; // Last high volume node price of the day calculated at bar update
+    int32_t lastSwingHighTicks = 0; // Last swing high price of the day calculated at bar update
+    int32_t lastSwingLowTicks = 0; // Last swing low price of the day calculated at bar update
+    int32_t lastHighVolumeNodeTicks = 0; // Last high volume node price of the day calculated at bar update
 
 // extras for calculations
     // rsi
     double prevAvgGain = std::nan("");
     double prevAvgLoss = std::nan("");
+    WilderAverage<14> rsiAvgGain; // gains of the closed bars' close to close changes
+    WilderAverage<14> rsiAvgLoss;
     // bbands
     double variance = 0.0;
+    RollingMeanVariance<21> bbSeedCloses; // closes of the first 21 bars, the seed of the smoothing
 
     // for vwap
     double cumulativePV = 0.0;
     double cumulativeSquarePV = 0.0;
 
     // for delta z-score
-    double deltaSum = 0.0;
-    double deltaSumOfSquares = 0.0;
+    RollingMeanVariance<11> deltaWindow; // delta of the last 11 closed bars
 
     // for cum delta slope
-    double avgAbsDelta10 = 0.0;
+    RollingLinearRegression<5> cumDeltaWindow; // cumDeltaAtBar of the last 5 closed bars
+
+    // for price cum delta divergence
+    SmoothedAverage<10> avgAbsDelta10; // smoothed absolute delta of the closed bars, (avg * 9 + x) / 10, updated once per bar
+    std::vector<DivergenceWindow> divergenceWindows; // one rolling regression state per lookback in use
 
 };
 
@@ -200,18 +338,22 @@ struct Week {
     double cumulativePV = 0.0;
     double cumulativeSquarePV = 0.0;
 
-    double poc = 0.0; // Point of Control for the week
-    double vah = 0.0; // Value Area High for the week
-    double val = 0.0; // Value Area Low for the week
-    double lastHighVolumeNode = 0.0; // Last high volume node price of the week
-    double weekHigh = 0.0; // Highest price of the week
-    double weekLow = 0.0; // Lowest price of the week
+    VolumeProfile profile; // volume of every tick of the week, fed by updateFootprint
+    // price levels of the week in ticks
+    int32_t pocTicks = 0; // Point of Control for the week
+    int32_t vahTicks = 0; // Value Area High for the week
+    int32_t valTicks = 0; // Value Area Low for the week
+    int32_t lastHighVolumeNodeTicks = 0; // Last high volume node price of the week
+    int32_t weekHighTicks = 0; // Highest price of the week
+    int32_t weekLowTicks = 0; // Lowest price of the week
 };
 
 
 struct Contract{
     std::vector<Week> weeks;
     std::string contractName = "contractName"; // Name of the futures contract
+    InstrumentSpec instrument = ES_SPEC; // tick size every price in ticks is converted with
+    SessionProfileStore sessionProfiles; // volume profile of every finished day, for composite profiles
     
 };
 
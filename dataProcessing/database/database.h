@@ -3,21 +3,101 @@
 
 #include <string>
 #include <vector>
+#include <memory>
+#include <span>
+#include <cstdint>
 #include <sqlite3.h>
 #include "../dataStructure.h"
 
+// packed tick record carried through the whole engine, strings are only formatted at export
 struct TickData {
-    int id;
-    std::string DateTime;
-    double Price;
-    double AskVolume;
-    double BidVolume;
+    int64_t DateTimeNs;   // ns since epoch of the DateTime column (see tickTime.h)
+    int32_t PriceTicks;   // price / tick size of the instrument
+    int32_t AskVolume;
+    int32_t BidVolume;
+    int32_t id;
 };
+static_assert(sizeof(TickData) == 24, "TickData is expected to stay a 24 byte record");
 
 
-std::vector<TickData> fetchData(const std::string& database_path, const std::string& table_name, const Date date);
+// where the engine reads its ticks from, one source object is owned by the whole processing run
+class TickSource {
+public:
+    virtual ~TickSource() = default;
 
-TickData fetchFirstTick(const std::string& database_path, const std::string& table_name, const Date date);
+    // fills ticks with every row of the given day, the vector is cleared first so its capacity is reused
+    virtual void fetchDay(const Date date, std::vector<TickData>& ticks) = 0;
 
+    // ticks of the given day, sources that hold the day in memory already return it in place,
+    // the others fetch it into buffer. the view is valid until the next call on the source
+    virtual std::span<const TickData> dayView(const Date date, std::vector<TickData>& buffer) {
+        fetchDay(date, buffer);
+        return buffer;
+    }
 
-#endif // DATABASE_H
\ No newline at end of file
+    // first row of the given day, id is -1 if the day has no data
+    virtual TickData fetchFirstTick(const Date date) = 0;
+
+    // opens one cursor over every tick from the start of day from to the end of day to, in DateTime order
+    virtual void openRange(const Date from, const Date to) = 0;
+
+    // reads the next tick of the open range into tick, false once the range is exhausted
+    virtual bool nextTick(TickData& tick) = 0;
+};
+
+
+// long lived read-only tick reader for one contract table, prices are rounded to ticks of tickSize
+// one connection and its prepared statements are kept open for the whole processing run
+// so fetching a day only rebinds the date instead of re-opening and re-preparing
+class SqliteTickSource : public TickSource {
+public:
+    SqliteTickSource(const std::string& database_path, const std::string& table_name, double tickSize);
+    ~SqliteTickSource() override;
+
+    SqliteTickSource(const SqliteTickSource&) = delete;
+    SqliteTickSource& operator=(const SqliteTickSource&) = delete;
+
+    void fetchDay(const Date date, std::vector<TickData>& ticks) override;
+    TickData fetchFirstTick(const Date date) override;
+    void openRange(const Date from, const Date to) override;
+    bool nextTick(TickData& tick) override;
+
+    const std::string& tableName() const { return table_name; }
+
+    // true if sqlite plans the day query through an index on DateTime instead of a full table scan
+    bool hasDateTimeIndex() const { return indexed; }
+
+    // creates the covering (DateTime, id, Price, AskVolume, BidVolume) index the day queries need
+    // this opens its own read-write connection, so call it before the read-only source is created
+    static void createDateTimeIndex(const std::string& database_path, const std::string& table_name);
+
+private:
+    sqlite3* db = nullptr;
+    sqlite3_stmt* dayStmt = nullptr;
+    sqlite3_stmt* firstTickStmt = nullptr;
+    sqlite3_stmt* rangeStmt = nullptr;
+    std::string table_name;
+    double tickSize;
+    bool indexed = false;
+};
+
+
+// tick source over a flat binary tick cache (see tick_cache_format.h), the file is memory mapped
+// and days are served straight from the mapping. the cache must have been written with tickSize
+std::unique_ptr<TickSource> openTickCacheSource(const std::string& path, double tickSize);
+
+
+#ifdef FOOTPRINT_WITH_PARQUET
+// tick source over the data_cleaner parquet output (id/DateTime/Price/AskVolume/BidVolume),
+// path is a single .parquet file or a data_cleaner output directory holding <tableName>.parquet, a <tableName>/ day
+// partitioned dataset or (--roll-map) the dataset itself, prices are rounded to ticks of tickSize
+std::unique_ptr<TickSource> openParquetTickSource(const std::string& path, const std::string& tableName, double tickSize);
+#endif
+
+
+std::vector<TickData> fetchData(const std::string& database_path, const std::string& table_name, const Date date, double tickSize);
+
+TickData fetchFirstTick(const std::string& database_path, const std::string& table_name, const Date date, double tickSize);
+
+
+#endif // DATABASE_H
@@ -1,4 +1,5 @@
 #include "json_writer.h"
+#include "../tickTime.h"
 #include <iostream>
 #include <fstream>
 #include <sstream>
@@ -12,12 +13,21 @@ std::string doubleToJson(double value) {
     return std::to_string(value);
 }
 
+// bar times are kept as ns in the engine and only formatted here, "-1" marks an unset time
+std::string timeToJson(int64_t ns) {
+    if (ns == NO_TIME) {
+        return "-1";
+    }
+    return formatDateTimeNs(ns);
+}
+
 // Forward declarations for serialization functions
 std::string priceLevelToJson(double price, const PriceLevel& pl);
-std::string footprintToJson(const Footprint& fp);
-std::string barToJson(const Bar& bar);
-std::string dayToJson(const Day& day);
-std::string weekToJson(const Week& week);
+// tick prices are converted with the contract's instrument spec, the json keeps plain prices
+std::string footprintToJson(const Footprint& fp, const InstrumentSpec& spec);
+std::string barToJson(const Bar& bar, const BarFeatures& features, const InstrumentSpec& spec);
+std::string dayToJson(const Day& day, const InstrumentSpec& spec);
+std::string weekToJson(const Week& week, const InstrumentSpec& spec);
 std::string contractToJson(const Contract& contract);
 
 std::string priceLevelToJson(double price, const PriceLevel& pl) {
@@ -34,90 +44,88 @@ std::string priceLevelToJson(double price, const PriceLevel& pl) {
     return ss.str();
 }
 
-std::string footprintToJson(const Footprint& fp) {
+std::string footprintToJson(const Footprint& fp, const InstrumentSpec& spec) {
     std::stringstream ss;
     ss << "[";
     bool first = true;
-    for (const auto& [price, level] : fp.priceLevels) {
+    fp.priceLevels.forEachLevel([&](int32_t tick, const PriceLevel& level) {
         if (!first) {
             ss << ",";
         }
-        ss << priceLevelToJson(price, level);
+        ss << priceLevelToJson(spec.toPrice(tick), level);
         first = false;
-    }
+    });
     ss << "]";
     return ss.str();
 }
 
-std::string barToJson(const Bar& bar) {
+std::string barToJson(const Bar& bar, const BarFeatures& features, const InstrumentSpec& spec) {
     std::stringstream ss;
     ss << "{";
-    ss << "\"startTime\": \"" << bar.startTime << "\",";
-    ss << "\"endTime\": \"" << bar.endTime << "\",";
-    ss << "\"open\": " << doubleToJson(bar.open) << ",";
-    ss << "\"high\": " << doubleToJson(bar.high) << ",";
-    ss << "\"low\": " << doubleToJson(bar.low) << ",";
-    ss << "\"close\": " << doubleToJson(bar.close) << ",";
+    ss << "\"startTime\": \"" << timeToJson(bar.startTime) << "\",";
+    ss << "\"endTime\": \"" << timeToJson(bar.endTime) << "\",";
+    ss << "\"open\": " << doubleToJson(spec.toPrice(bar.openTicks)) << ",";
+    ss << "\"high\": " << doubleToJson(spec.toPrice(bar.highTicks)) << ",";
+    ss << "\"low\": " << doubleToJson(spec.toPrice(bar.lowTicks)) << ",";
+    ss << "\"close\": " << doubleToJson(spec.toPrice(bar.closeTicks)) << ",";
     ss << "\"barTotalVolume\": " << bar.barTotalVolume << ",";
-    ss << "\"footprint\": " << footprintToJson(bar.footprint) << ",";
+    ss << "\"footprint\": " << footprintToJson(bar.footprint, spec) << ",";
     ss << "\"buyImbalanceCount\": " << bar.buyImbalanceCount << ",";
     ss << "\"sellImbalanceCount\": " << bar.sellImbalanceCount << ",";
     ss << "\"delta\": " << bar.delta << ",";
     ss << "\"barDeltaChange\": " << bar.barDeltaChange << ",";
     ss << "\"barHighDelta\": " << bar.barHighDelta << ",";
     ss << "\"barLowDelta\": " << bar.barLowDelta << ",";
-    ss << "\"barPOCPrice\": " << doubleToJson(bar.barPOCPrice) << ",";
+    ss << "\"barPOCPrice\": " << doubleToJson(spec.toPrice(bar.barPOCTicks)) << ",";
     ss << "\"barPOCVol\": " << bar.barPOCVol << ",";    
     ss << "\"signal\": " << bar.signal << ",";
     ss << "\"signalID\": " << bar.signalID << ",";
     ss << "\"signalStatus\": " << (bar.signalStatus ? "true" : "false") << ",";
-    ss << "\"priceCurrentDayVwapDiff\": " << doubleToJson(bar.priceCurrentDayVwapDiff) << ",";
-    ss << "\"priceCurrentDayVwapUpperStdDevDiff\": " << doubleToJson(bar.priceCurrentDayVwapUpperStdDev1Diff) << ",";
-    ss << "\"priceCurrentDayVwapLowerStdDevDiff\": " << doubleToJson(bar.priceCurrentDayVwapLowerStdDev1Diff) << ",";
-    ss << "\"priceCurrentDayVwapUpperStdDevDiff\": " << doubleToJson(bar.priceCurrentDayVwapUpperStdDev2Diff) << ",";
-    ss << "\"priceCurrentDayVwapLowerStdDevDiff\": " << doubleToJson(bar.priceCurrentDayVwapLowerStdDev2Diff) << ",";
-    ss << "\"pricePreviousDayVwapDiff\": " << doubleToJson(bar.pricePreviousDayVwapDiff) << ",";
-    ss << "\"priceWeeklyVwapDiff\": " << doubleToJson(bar.priceWeeklyVwapDiff) << ",";
-    ss << "\"priceWeeklyVwapUpperStdDevDiff\": " << doubleToJson(bar.priceWeeklyVwapUpperStdDev1Diff) << ",";
-    ss << "\"priceWeeklyVwapLowerStdDevDiff\": " << doubleToJson(bar.priceWeeklyVwapLowerStdDev1Diff) << ",";
-    ss << "\"priceBBandUpperDiff\": " << doubleToJson(bar.priceBBandUpperDiff) << ",";
-    ss << "\"priceBBandLowerDiff\": " << doubleToJson(bar.priceBBandLowerDiff) << ",";
-    ss << "\"PriceBBandMiddleDiff\": " << doubleToJson(bar.PriceBBandMiddleDiff) << ",";
-    ss << "\"isPriceInCurrentDayVA\": " << (bar.isPriceInCurrentDayVA ? "true" : "false") << ",";
-    ss << "\"isPriceInPrevDayVA\": " << (bar.isPriceInPrevDayVA ? "true" : "false") << ",";
-    ss << "\"priceCurrDayVAHDiff\": " << doubleToJson(bar.priceCurrDayVAHDiff) << ",";
-    ss << "\"priceCurrDayVALDiff\": " << doubleToJson(bar.priceCurrDayVALDiff) << ",";
-    ss << "\"pricePrevDayPOCDiff\": " << doubleToJson(bar.pricePrevDayPOCDiff) << ",";
-    ss << "\"pricePrevDayVAHDiff\": " << doubleToJson(bar.pricePrevDayVAHDiff) << ",";
-    ss << "\"pricePrevDayVALDiff\": " << doubleToJson(bar.pricePrevDayVALDiff) << ",";
-    ss << "\"priceIBHighDiff\": " << doubleToJson(bar.priceIBHighDiff) << ",";
-    ss << "\"priceIBLowDiff\": " << doubleToJson(bar.priceIBLowDiff) << ",";
-    ss << "\"pricePrevDayHighDiff\": " << doubleToJson(bar.pricePrevDayHighDiff) << ",";
-    ss << "\"pricePrevDayLowDiff\": " << doubleToJson(bar.pricePrevDayLowDiff) << ",";
-    ss << "\"pricePrevDayCloseDiff\": " << doubleToJson(bar.pricePrevDayCloseDiff) << ",";
-    ss << "\"priceCurrentWeekHighDiff\": " << doubleToJson(bar.priceCurrentWeekHighDiff) << ",";
-    ss << "\"priceCurrentWeekLowDiff\": " << doubleToJson(bar.priceCurrentWeekLowDiff) << ",";
-    ss << "\"pricePrevWeekHighDiff\": " << doubleToJson(bar.pricePrevWeekHighDiff) << ",";
-    ss << "\"pricePrevWeekLowDiff\": " << doubleToJson(bar.pricePrevWeekLowDiff) << ",";
-    ss << "\"priceLastSwingHighDiff\": " << doubleToJson(bar.priceLastSwingHighDiff) << ",";
-    ss << "\"priceLastSwingLowDiff\": " << doubleToJson(bar.priceLastSwingLowDiff) << ",";
-    ss << "\"priceLastHVNDiff\": " << doubleToJson(bar.priceLastHVNDiff);
+    ss << "\"priceCurrentDayVwapDiff\": " << doubleToJson(features.priceCurrentDayVwapDiff) << ",";
+    ss << "\"priceCurrentDayVwapUpperStdDevDiff\": " << doubleToJson(features.priceCurrentDayVwapUpperStdDev1Diff) << ",";
+    ss << "\"priceCurrentDayVwapLowerStdDevDiff\": " << doubleToJson(features.priceCurrentDayVwapLowerStdDev1Diff) << ",";
+    ss << "\"priceCurrentDayVwapUpperStdDevDiff\": " << doubleToJson(features.priceCurrentDayVwapUpperStdDev2Diff) << ",";
+    ss << "\"priceCurrentDayVwapLowerStdDevDiff\": " << doubleToJson(features.priceCurrentDayVwapLowerStdDev2Diff) << ",";
+    ss << "\"pricePreviousDayVwapDiff\": " << doubleToJson(features.pricePreviousDayVwapDiff) << ",";
+    ss << "\"priceWeeklyVwapDiff\": " << doubleToJson(features.priceWeeklyVwapDiff) << ",";
+    ss << "\"priceWeeklyVwapUpperStdDevDiff\": " << doubleToJson(features.priceWeeklyVwapUpperStdDev1Diff) << ",";
+    ss << "\"priceWeeklyVwapLowerStdDevDiff\": " << doubleToJson(features.priceWeeklyVwapLowerStdDev1Diff) << ",";
+    ss << "\"priceBBandUpperDiff\": " << doubleToJson(features.priceBBandUpperDiff) << ",";
+    ss << "\"priceBBandLowerDiff\": " << doubleToJson(features.priceBBandLowerDiff) << ",";
+    ss << "\"PriceBBandMiddleDiff\": " << doubleToJson(features.PriceBBandMiddleDiff) << ",";
+    ss << "\"isPriceInCurrentDayVA\": " << (features.isPriceInCurrentDayVA ? "true" : "false") << ",";
+    ss << "\"isPriceInPrevDayVA\": " << (features.isPriceInPrevDayVA ? "true" : "false") << ",";
+    ss << "\"priceCurrDayVAHDiff\": " << doubleToJson(features.priceCurrDayVAHDiff) << ",";
+    ss << "\"priceCurrDayVALDiff\": " << doubleToJson(features.priceCurrDayVALDiff) << ",";
+    ss << "\"pricePrevDayPOCDiff\": " << doubleToJson(features.pricePrevDayPOCDiff) << ",";
+    ss << "\"pricePrevDayVAHDiff\": " << doubleToJson(features.pricePrevDayVAHDiff) << ",";
+    ss << "\"pricePrevDayVALDiff\": " << doubleToJson(features.pricePrevDayVALDiff) << ",";
+    ss << "\"priceIBHighDiff\": " << doubleToJson(features.priceIBHighDiff) << ",";
+    ss << "\"priceIBLowDiff\": " << doubleToJson(features.priceIBLowDiff) << ",";
+    ss << "\"pricePrevDayHighDiff\": " << doubleToJson(features.pricePrevDayHighDiff) << ",";
+    ss << "\"pricePrevDayLowDiff\": " << doubleToJson(features.pricePrevDayLowDiff) << ",";
+    ss << "\"pricePrevDayCloseDiff\": " << doubleToJson(features.pricePrevDayCloseDiff) << ",";
+    ss << "\"priceCurrentWeekHighDiff\": " << doubleToJson(features.priceCurrentWeekHighDiff) << ",";
+    ss << "\"priceCurrentWeekLowDiff\": " << doubleToJson(features.priceCurrentWeekLowDiff) << ",";
+    ss << "\"pricePrevWeekHighDiff\": " << doubleToJson(features.pricePrevWeekHighDiff) << ",";
+    ss << "\"pricePrevWeekLowDiff\": " << doubleToJson(features.pricePrevWeekLowDiff) << ",";
+    ss << "\"priceLastSwingHighDiff\": " << doubleToJson(features.priceLastSwingHighDiff) << ",";
+    ss << "\"priceLastSwingLowDiff\": " << doubleToJson(features.priceLastSwingLowDiff) << ",";
+    ss << "\"priceLastHVNDiff\": " << doubleToJson(features.priceLastHVNDiff);
     ss << "}";
     return ss.str();
 }
 
-std::string dayToJson(const Day& day) {
+std::string dayToJson(const Day& day, const InstrumentSpec& spec) {
     std::stringstream ss;
     ss << "{";
     ss << "\"dayOfTheWeek\": \"" << day.dayOfTheWeek << "\",";
     ss << "\"bars\": [";
-    bool first = true;
-    for (const auto& bar : day.bars) {
-        if (!first) {
+    for (size_t i = 0; i < day.bars.size(); ++i) {
+        if (i > 0) {
             ss << ",";
         }
-        ss << barToJson(bar);
-        first = false;
+        ss << barToJson(day.bars[i], day.barFeatures[i], spec);
     }
     ss << "]";
     ss << ",";
@@ -125,6 +133,8 @@ std::string dayToJson(const Day& day) {
     ss << "\"cumDelta5barSlope\": " << doubleToJson(day.cumDelta5barSlope) << ",";
     ss << "\"priceCumDeltaDivergence5bar\": " << doubleToJson(day.priceCumDeltaDivergence5bar) << ",";
     ss << "\"priceCumDeltaDivergence10bar\": " << doubleToJson(day.priceCumDeltaDivergence10bar) << ",";
+    ss << "\"priceCumDeltaDivergence20bar\": " << doubleToJson(day.priceCumDeltaDivergence20bar) << ",";
+    ss << "\"priceCumDeltaDivergence50bar\": " << doubleToJson(day.priceCumDeltaDivergence50bar) << ",";
     ss << "\"interactionReversal\": " << doubleToJson(day.interactionReversal) << ",";
     ss << "\"vwap\": " << doubleToJson(day.vwap) << ",";
     ss << "\"vwapUpperStdDev1\": " << doubleToJson(day.vwapUpperStdDev1) << ",";
@@ -137,19 +147,22 @@ std::string dayToJson(const Day& day) {
     ss << "\"bbLower\": " << doubleToJson(day.bbLower) << ",";
     ss << "\"BBandWidth\": " << doubleToJson(day.BBandWidth) << ",";
     ss << "\"rsi\": " << doubleToJson(day.rsi) << ",";
-    ss << "\"poc\": " << doubleToJson(day.poc) << ",";
-    ss << "\"vah\": " << doubleToJson(day.vah) << ",";
-    ss << "\"val\": " << doubleToJson(day.val) << ",";
-    ss << "\"ibHigh\": " << doubleToJson(day.ibHigh) << ",";
-    ss << "\"ibLow\": " << doubleToJson(day.ibLow) << ",";
-    ss << "\"dayHigh\": " << doubleToJson(day.dayHigh) << ",";
-    ss << "\"dayLow\": " << doubleToJson(day.dayLow) << ",";
-    ss << "\"dayClose\": " << doubleToJson(day.dayClose) << ",";
+    ss << "\"poc\": " << doubleToJson(spec.toPrice(day.pocTicks)) << ",";
+    ss << "\"vah\": " << doubleToJson(spec.toPrice(day.vahTicks)) << ",";
+    ss << "\"val\": " << doubleToJson(spec.toPrice(day.valTicks)) << ",";
+    ss << "\"compositePoc\": " << doubleToJson(spec.toPrice(day.compositePocTicks)) << ",";
+    ss << "\"compositeVah\": " << doubleToJson(spec.toPrice(day.compositeVahTicks)) << ",";
+    ss << "\"compositeVal\": " << doubleToJson(spec.toPrice(day.compositeValTicks)) << ",";
+    ss << "\"ibHigh\": " << doubleToJson(spec.toPrice(day.ibHighTicks)) << ",";
+    ss << "\"ibLow\": " << doubleToJson(spec.toPrice(day.ibLowTicks)) << ",";
+    ss << "\"dayHigh\": " << doubleToJson(spec.toPrice(day.dayHighTicks)) << ",";
+    ss << "\"dayLow\": " << doubleToJson(spec.toPrice(day.dayLowTicks)) << ",";
+    ss << "\"dayClose\": " << doubleToJson(spec.toPrice(day.dayCloseTicks)) << ",";
     ss << "\"totalVolume\": " << day.totalVolume << ",";
     ss << "\"cumulativeDelta\": " << day.cumulativeDelta << ",";
-    ss << "\"lastSwingHigh\": " << doubleToJson(day.lastSwingHigh) << ",";
-    ss << "\"lastSwingLow\": " << doubleToJson(day.lastSwingLow) << ",";
-    ss << "\"lastHighVolumeNode\": " << doubleToJson(day.lastHighVolumeNode) << ",";
+    ss << "\"lastSwingHigh\": " << doubleToJson(spec.toPrice(day.lastSwingHighTicks)) << ",";
+    ss << "\"lastSwingLow\": " << doubleToJson(spec.toPrice(day.lastSwingLowTicks)) << ",";
+    ss << "\"lastHighVolumeNode\": " << doubleToJson(spec.toPrice(day.lastHighVolumeNodeTicks)) << ",";
     ss << "\"prevAvgGain\": " << doubleToJson(day.prevAvgGain) << ",";
     ss << "\"prevAvgLoss\": " << doubleToJson(day.prevAvgLoss) << ",";
     ss << "\"variance\": " << doubleToJson(day.variance) << ",";
@@ -159,7 +172,7 @@ std::string dayToJson(const Day& day) {
     return ss.str();
 }
 
-std::string weekToJson(const Week& week) {
+std::string weekToJson(const Week& week, const InstrumentSpec& spec) {
     std::stringstream ss;
     ss << "{";
     ss << "\"weekOfTheContract\": \"" << week.weekOfTheContract << "\",";
@@ -169,7 +182,7 @@ std::string weekToJson(const Week& week) {
         if (!first) {
             ss << ",";
         }
-        ss << dayToJson(day);
+        ss << dayToJson(day, spec);
         first = false;
     }
     ss << "]";
@@ -179,11 +192,11 @@ std::string weekToJson(const Week& week) {
     ss << "\"vwapUpperStdDev1\": " << doubleToJson(week.vwapUpperStdDev1) << ",";
     ss << "\"vwapLowerStdDev1\": " << doubleToJson(week.vwapLowerStdDev1) << ",";
     ss << "\"vwapBandWidth\": " << doubleToJson(week.vwapBandWidth) << ",";
-    ss << "\"poc\": " << doubleToJson(week.poc) << ",";
-    ss << "\"vah\": " << doubleToJson(week.vah) << ",";
-    ss << "\"val\": " << doubleToJson(week.val) << ",";
-    ss << "\"weekHigh\": " << doubleToJson(week.weekHigh) << ",";
-    ss << "\"weekLow\": " << doubleToJson(week.weekLow);
+    ss << "\"poc\": " << doubleToJson(spec.toPrice(week.pocTicks)) << ",";
+    ss << "\"vah\": " << doubleToJson(spec.toPrice(week.vahTicks)) << ",";
+    ss << "\"val\": " << doubleToJson(spec.toPrice(week.valTicks)) << ",";
+    ss << "\"weekHigh\": " << doubleToJson(spec.toPrice(week.weekHighTicks)) << ",";
+    ss << "\"weekLow\": " << doubleToJson(spec.toPrice(week.weekLowTicks));
     ss << "}";
     return ss.str();
 }
@@ -198,7 +211,7 @@ std::string contractToJson(const Contract& contract) {
         if (!first) {
             ss << ",";
         }
-        ss << weekToJson(week);
+        ss << weekToJson(week, contract.instrument);
         first = false;
     }
     ss << "]";
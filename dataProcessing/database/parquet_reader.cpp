@@ -0,0 +1,375 @@
+#include <string>
+#include <vector>
+#include <memory>
+#include <iostream>
+#include <stdexcept>
+#include <algorithm>
+#include <filesystem>
+#include <cmath>
+
+#include <arrow/api.h>
+#include <arrow/io/api.h>
+#include <parquet/arrow/reader.h>
+#include <parquet/metadata.h>
+#include <parquet/statistics.h>
+
+#include "database.h"
+#include "../convertDatesToWeek.h"
+#include "../tickTime.h"
+
+
+namespace {
+
+// column order the source asks arrow for
+enum TickColumn { COL_ID = 0, COL_DATETIME, COL_PRICE, COL_ASK, COL_BID, COL_COUNT };
+const char* TICK_COLUMN_NAMES[COL_COUNT] = {"id", "DateTime", "Price", "AskVolume", "BidVolume"};
+
+
+// one parquet file of the dataset with the positions of the tick columns inside it
+struct ParquetTickFile {
+    std::string path;
+    std::unique_ptr<parquet::arrow::FileReader> reader;
+    std::vector<int> columns;   // arrow field index of each TickColumn
+    int dateTimeLeaf = -1;      // parquet leaf column of DateTime, for the row group statistics
+    int64_t dateTimeUnitNs = 1; // ns per raw DateTime value (and statistic), from the timestamp unit
+};
+
+
+// ns per value of a timestamp column, the engine keeps every time in ns
+int64_t nsPerUnit(const arrow::DataType& type) {
+    if (type.id() != arrow::Type::TIMESTAMP) {
+        throw std::runtime_error("DateTime is not a timestamp column: " + type.ToString());
+    }
+    switch (static_cast<const arrow::TimestampType&>(type).unit()) {
+        case arrow::TimeUnit::SECOND: return 1000000000;
+        case arrow::TimeUnit::MILLI: return 1000000;
+        case arrow::TimeUnit::MICRO: return 1000;
+        case arrow::TimeUnit::NANO: return 1;
+    }
+    return 1;
+}
+
+
+// raw values of an integer column, the data_cleaner writes int64 but narrower columns are accepted.
+// a null slot has no value to copy, so columns with nulls are rejected
+template <typename Out>
+void copyIntegerColumn(const arrow::Array& array, const char* name, std::vector<Out>& out) {
+    if (array.null_count() > 0) {
+        throw std::runtime_error(std::string("Parquet column ") + name + " contains nulls");
+    }
+    out.resize(array.length());
+    switch (array.type_id()) {
+        case arrow::Type::INT64:
+        case arrow::Type::TIMESTAMP: {
+            const int64_t* values = array.data()->GetValues<int64_t>(1);
+            std::copy(values, values + array.length(), out.begin());
+            break;
+        }
+        case arrow::Type::INT32: {
+            const int32_t* values = array.data()->GetValues<int32_t>(1);
+            std::copy(values, values + array.length(), out.begin());
+            break;
+        }
+        default:
+            throw std::runtime_error("Unsupported parquet column type: " + array.type()->ToString());
+    }
+}
+
+
+// true for <root>/year=YYYY/month=MM/day=DD/<file>, the layout data_cleaner --partitioned / --roll-map writes
+bool isDayPartition(const std::filesystem::path& relative) {
+    std::vector<std::string> parts;
+    for (const auto& part : relative) {
+        parts.push_back(part.string());
+    }
+    return parts.size() == 4 && parts[0].rfind("year=", 0) == 0 && parts[1].rfind("month=", 0) == 0 &&
+           parts[2].rfind("day=", 0) == 0;
+}
+
+
+// parquet files of table_name under path, in time order:
+// path itself if it is a file, else <path>/<table_name>.parquet, else the day partitioned dataset
+// <path>/<table_name>/ or path. a dataset directory must only hold day partitions, anything else
+// (e.g. the per table files of several contracts) can't be ordered by time and is rejected
+std::vector<std::string> resolveParquetFiles(const std::string& path, const std::string& tableName) {
+    namespace fs = std::filesystem;
+    if (!fs::is_directory(path)) {
+        return {path};
+    }
+    const fs::path tableFile = fs::path(path) / (tableName + ".parquet");
+    if (fs::is_regular_file(tableFile)) {
+        return {tableFile.string()};
+    }
+    const fs::path root = fs::is_directory(fs::path(path) / tableName) ? fs::path(path) / tableName : fs::path(path);
+
+    std::vector<std::string> paths;
+    for (const auto& entry : fs::recursive_directory_iterator(root)) {
+        if (!entry.is_regular_file() || entry.path().extension() != ".parquet") {
+            continue;
+        }
+        if (!isDayPartition(entry.path().lexically_relative(root))) {
+            throw std::runtime_error("Parquet directory " + root.string() + " is not a year=/month=/day= dataset of " +
+                                     tableName + " (found " + entry.path().string() + ")");
+        }
+        paths.push_back(entry.path().string());
+    }
+    if (paths.empty()) {
+        throw std::runtime_error("No parquet data for " + tableName + " in: " + path);
+    }
+    // zero padded partitions sort chronologically, data.parquet before the data_NNNN.parquet written after it
+    std::sort(paths.begin(), paths.end());
+    return paths;
+}
+
+
+class ParquetTickSource : public TickSource {
+public:
+    ParquetTickSource(const std::string& path, const std::string& tableName, double tickSize);
+
+    void fetchDay(const Date date, std::vector<TickData>& ticks) override;
+    TickData fetchFirstTick(const Date date) override;
+    void openRange(const Date from, const Date to) override;
+    bool nextTick(TickData& tick) override;
+
+private:
+    void openFile(const std::string& path);
+
+    // row groups of a file whose DateTime min/max overlap [from, to), row groups without statistics are kept
+    std::vector<int> prunedRowGroups(const ParquetTickFile& file, int64_t from, int64_t to) const;
+
+    // decodes the ticks of one record batch of file that fall in [from, to) and appends them to out
+    void appendBatch(const ParquetTickFile& file, const arrow::RecordBatch& batch, int64_t from, int64_t to, std::vector<TickData>& out);
+
+    // reads every tick of [from, to), stops early once limit ticks are collected (0 = no limit)
+    void scan(int64_t from, int64_t to, size_t limit, std::vector<TickData>& out);
+
+    // moves the open range to its next non empty batch, false once every file is exhausted
+    bool nextBatch();
+
+    std::vector<ParquetTickFile> files;
+    double tickSize;
+
+    // state of the open range
+    int64_t rangeFrom = 0;
+    int64_t rangeTo = 0;
+    size_t rangeFile = 0;
+    std::unique_ptr<arrow::RecordBatchReader> rangeReader;
+    std::vector<TickData> rangeTicks;
+    size_t rangePos = 0;
+
+    // column scratch reused for every batch
+    std::vector<int64_t> timeScratch;
+    std::vector<int64_t> idScratch;
+    std::vector<int64_t> askScratch;
+    std::vector<int64_t> bidScratch;
+};
+
+
+ParquetTickSource::ParquetTickSource(const std::string& path, const std::string& tableName, double tickSize) : tickSize(tickSize) {
+    for (const auto& file : resolveParquetFiles(path, tableName)) {
+        openFile(file);
+    }
+}
+
+
+void ParquetTickSource::openFile(const std::string& path) {
+    ParquetTickFile file;
+    file.path = path;
+
+    auto input = arrow::io::MemoryMappedFile::Open(path, arrow::io::FileMode::READ);
+    if (!input.ok()) {
+        throw std::runtime_error("Can't open parquet file: " + input.status().ToString());
+    }
+    auto reader = parquet::arrow::OpenFile(*input, arrow::default_memory_pool());
+    if (!reader.ok()) {
+        throw std::runtime_error("Can't read parquet file " + path + ": " + reader.status().ToString());
+    }
+    file.reader = std::move(*reader);
+
+    std::shared_ptr<arrow::Schema> schema;
+    auto status = file.reader->GetSchema(&schema);
+    if (!status.ok()) {
+        throw std::runtime_error("Can't read parquet schema of " + path + ": " + status.ToString());
+    }
+    for (int c = 0; c < COL_COUNT; ++c) {
+        int index = schema->GetFieldIndex(TICK_COLUMN_NAMES[c]);
+        if (index < 0) {
+            throw std::runtime_error("Parquet file " + path + " has no column " + TICK_COLUMN_NAMES[c]);
+        }
+        file.columns.push_back(index);
+    }
+    // compact files (data_cleaner --compact) store Price as ticks, only usable if the tick sizes agree
+    if (schema->field(file.columns[COL_PRICE])->type()->id() == arrow::Type::INT32) {
+        auto fileTickSize = schema->metadata() ? schema->metadata()->Get("tick_size") : arrow::Status::KeyError("tick_size");
+        if (!fileTickSize.ok()) {
+            throw std::runtime_error("Parquet file " + path + " stores Price as ticks but has no tick_size metadata");
+        }
+        if (std::stod(*fileTickSize) != tickSize) {
+            throw std::runtime_error("Parquet file " + path + " was written with tick size " + *fileTickSize);
+        }
+    }
+    // the row group statistics and the raw values are in the file's unit, scaled to ns when read
+    file.dateTimeUnitNs = nsPerUnit(*schema->field(file.columns[COL_DATETIME])->type());
+    file.dateTimeLeaf = file.reader->parquet_reader()->metadata()->schema()->ColumnIndex(TICK_COLUMN_NAMES[COL_DATETIME]);
+
+    files.push_back(std::move(file));
+}
+
+
+std::vector<int> ParquetTickSource::prunedRowGroups(const ParquetTickFile& file, int64_t from, int64_t to) const {
+    std::vector<int> rowGroups;
+    auto metadata = file.reader->parquet_reader()->metadata();
+    for (int rg = 0; rg < metadata->num_row_groups(); ++rg) {
+        if (file.dateTimeLeaf >= 0) {
+            auto chunk = metadata->RowGroup(rg)->ColumnChunk(file.dateTimeLeaf);
+            auto stats = chunk->is_stats_set() ? chunk->statistics() : nullptr;
+            if (stats && stats->HasMinMax() && stats->physical_type() == parquet::Type::INT64) {
+                auto typed = std::static_pointer_cast<parquet::Int64Statistics>(stats);
+                if (typed->max() * file.dateTimeUnitNs < from || typed->min() * file.dateTimeUnitNs >= to) {
+                    continue;
+                }
+            }
+        }
+        rowGroups.push_back(rg);
+    }
+    return rowGroups;
+}
+
+
+void ParquetTickSource::appendBatch(const ParquetTickFile& file, const arrow::RecordBatch& batch, int64_t from, int64_t to, std::vector<TickData>& out) {
+    const int64_t rows = batch.num_rows();
+    copyIntegerColumn(*batch.column(COL_DATETIME), TICK_COLUMN_NAMES[COL_DATETIME], timeScratch);
+    copyIntegerColumn(*batch.column(COL_ID), TICK_COLUMN_NAMES[COL_ID], idScratch);
+    copyIntegerColumn(*batch.column(COL_ASK), TICK_COLUMN_NAMES[COL_ASK], askScratch);
+    copyIntegerColumn(*batch.column(COL_BID), TICK_COLUMN_NAMES[COL_BID], bidScratch);
+
+    const arrow::Array& priceArray = *batch.column(COL_PRICE);
+    if (priceArray.null_count() > 0) {
+        throw std::runtime_error(std::string("Parquet column ") + TICK_COLUMN_NAMES[COL_PRICE] + " contains nulls");
+    }
+    const double* prices = nullptr;
+    const int32_t* priceTicks = nullptr;
+    if (priceArray.type_id() == arrow::Type::DOUBLE) {
+        prices = priceArray.data()->GetValues<double>(1);
+    } else if (priceArray.type_id() == arrow::Type::INT32) {
+        priceTicks = priceArray.data()->GetValues<int32_t>(1);
+    } else {
+        throw std::runtime_error("Unsupported parquet Price type: " + priceArray.type()->ToString());
+    }
+
+    for (int64_t i = 0; i < rows; ++i) {
+        const int64_t t = timeScratch[i] * file.dateTimeUnitNs;
+        if (t < from || t >= to) {
+            continue;
+        }
+        TickData tick;
+        tick.DateTimeNs = t;
+        tick.PriceTicks = prices ? static_cast<int32_t>(std::llround(prices[i] / tickSize)) : priceTicks[i];
+        tick.AskVolume = static_cast<int32_t>(askScratch[i]);
+        tick.BidVolume = static_cast<int32_t>(bidScratch[i]);
+        tick.id = static_cast<int32_t>(idScratch[i]);
+        out.push_back(tick);
+    }
+}
+
+
+void ParquetTickSource::scan(int64_t from, int64_t to, size_t limit, std::vector<TickData>& out) {
+    for (auto& file : files) {
+        std::vector<int> rowGroups = prunedRowGroups(file, from, to);
+        if (rowGroups.empty()) {
+            continue;
+        }
+        auto batches = file.reader->GetRecordBatchReader(rowGroups, file.columns);
+        if (!batches.ok()) {
+            std::cerr << "Failed to fetch data: " << batches.status().ToString() << std::endl;
+            continue;
+        }
+        std::shared_ptr<arrow::RecordBatch> batch;
+        while ((*batches)->ReadNext(&batch).ok() && batch) {
+            appendBatch(file, *batch, from, to, out);
+            if (limit != 0 && out.size() >= limit) {
+                out.resize(limit);
+                return;
+            }
+        }
+    }
+}
+
+
+void ParquetTickSource::fetchDay(const Date date, std::vector<TickData>& ticks) {
+    ticks.clear();
+    scan(dateToNs(date), dateToNs(addDay(date)), 0, ticks);
+}
+
+
+TickData ParquetTickSource::fetchFirstTick(const Date date) {
+    std::vector<TickData> first;
+    scan(dateToNs(date), dateToNs(addDay(date)), 1, first);
+    if (first.empty()) {
+        TickData result = {};
+        result.id = -1; // Use -1 to indicate failure or no data found
+        return result;
+    }
+    return first.front();
+}
+
+
+void ParquetTickSource::openRange(const Date from, const Date to) {
+    rangeFrom = dateToNs(from);
+    rangeTo = dateToNs(addDay(to));
+    rangeFile = 0;
+    rangeReader.reset();
+    rangeTicks.clear();
+    rangePos = 0;
+}
+
+
+bool ParquetTickSource::nextBatch() {
+    while (rangeFile < files.size()) {
+        if (!rangeReader) {
+            auto& file = files[rangeFile];
+            std::vector<int> rowGroups = prunedRowGroups(file, rangeFrom, rangeTo);
+            if (rowGroups.empty()) {
+                ++rangeFile;
+                continue;
+            }
+            auto batches = file.reader->GetRecordBatchReader(rowGroups, file.columns);
+            if (!batches.ok()) {
+                std::cerr << "Failed to fetch data: " << batches.status().ToString() << std::endl;
+                ++rangeFile;
+                continue;
+            }
+            rangeReader = std::move(*batches);
+        }
+
+        std::shared_ptr<arrow::RecordBatch> batch;
+        if (!rangeReader->ReadNext(&batch).ok() || !batch) {
+            rangeReader.reset();
+            ++rangeFile;
+            continue;
+        }
+        rangeTicks.clear();
+        rangePos = 0;
+        appendBatch(files[rangeFile], *batch, rangeFrom, rangeTo, rangeTicks);
+        if (!rangeTicks.empty()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+bool ParquetTickSource::nextTick(TickData& tick) {
+    if (rangePos >= rangeTicks.size() && !nextBatch()) {
+        return false;
+    }
+    tick = rangeTicks[rangePos++];
+    return true;
+}
+
+} // namespace
+
+
+std::unique_ptr<TickSource> openParquetTickSource(const std::string& path, const std::string& tableName, double tickSize) {
+    return std::make_unique<ParquetTickSource>(path, tableName, tickSize);
+}
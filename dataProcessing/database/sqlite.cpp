@@ -2,108 +2,226 @@
 #include <vector>
 #include <sqlite3.h>
 #include <iostream>
+#include <stdexcept>
+#include <cmath>
 #include "database.h"
 #include "../dataStructure.h"
+#include "../convertDatesToWeek.h"
+#include "../tickTime.h"
 
 
-std::vector<TickData> fetchData(const std::string& database_path, const std::string& table_name, const Date date) {
-    std::vector<TickData> result;
-    sqlite3* db;
-    
-    // Open database
-    int rc = sqlite3_open(database_path.c_str(), &db);
-    if (rc) {
-        std::cerr << "Can't open database: " << sqlite3_errmsg(db) << std::endl;
-        return result;
+// connection tuning for the read-only tick scans
+// mmap lets sqlite read pages straight from the page cache, the large cache keeps the index and
+// table pages of previous days warm and query_only guards the source database against writes
+static const char* TICK_SOURCE_PRAGMAS =
+    "PRAGMA mmap_size = 268435456;"
+    "PRAGMA cache_size = -131072;"
+    "PRAGMA temp_store = MEMORY;"
+    "PRAGMA query_only = ON;";
+
+
+// day bounds as DateTime text, the half-open [from, day after to) range compares lexicographically
+// against "YYYY-MM-DD HH:MM:SS.ffffff" so sqlite can seek an index instead of calling strftime() per row
+static void bindDayRange(sqlite3_stmt* stmt, const Date from, const Date to) {
+    Date next = addDay(to);
+    char from_str[11];
+    char to_str[11];
+    snprintf(from_str, sizeof(from_str), "%04d-%02d-%02d", from.y, from.m, from.d);
+    snprintf(to_str, sizeof(to_str), "%04d-%02d-%02d", next.y, next.m, next.d);
+
+    sqlite3_bind_text(stmt, 1, from_str, -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt, 2, to_str, -1, SQLITE_TRANSIENT);
+}
+
+
+static std::string tickIndexName(const std::string& table_name) {
+    return "idx_" + table_name + "_DateTime";
+}
+
+
+// asks the query planner whether the statement seeks an index or scans the whole table.
+// only a SEARCH row counts, "SCAN <t> USING [COVERING] INDEX" still reads every row of the index
+static bool usesIndex(sqlite3* db, const std::string& sql) {
+    sqlite3_stmt* plan = nullptr;
+    bool found = false;
+    if (sqlite3_prepare_v2(db, ("EXPLAIN QUERY PLAN " + sql).c_str(), -1, &plan, nullptr) != SQLITE_OK) {
+        return false;
+    }
+    while (sqlite3_step(plan) == SQLITE_ROW) {
+        std::string detail = reinterpret_cast<const char*>(sqlite3_column_text(plan, 3));
+        if (detail.rfind("SEARCH", 0) == 0 && detail.find(" INDEX ") != std::string::npos) {
+            found = true;
+        }
     }
+    sqlite3_finalize(plan);
+    return found;
+}
+
 
-    // Format date string YYYY-MM-DD
-    char date_str[11];
-    snprintf(date_str, sizeof(date_str), "%04d-%02d-%02d", date.y, date.m, date.d);
-
-    // Prepare SQL statement with proper date filtering
-    std::string sql = "SELECT id, DateTime, Price, AskVolume, BidVolume FROM " + 
-                     table_name + 
-                     " WHERE strftime('%Y-%m-%d', DateTime) = ?";
-    
-    sqlite3_stmt* stmt;
-    rc = sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr);
-    
+static void readTickRow(sqlite3_stmt* stmt, double tickSize, TickData& tick) {
+    tick.id = sqlite3_column_int(stmt, 0);
+    tick.DateTimeNs = parseDateTimeNs(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1)));
+    tick.PriceTicks = static_cast<int32_t>(std::llround(sqlite3_column_double(stmt, 2) / tickSize));
+    tick.AskVolume = sqlite3_column_int(stmt, 3);
+    tick.BidVolume = sqlite3_column_int(stmt, 4);
+}
+
+
+SqliteTickSource::SqliteTickSource(const std::string& database_path, const std::string& table_name, double tickSize)
+    : table_name(table_name), tickSize(tickSize) {
+    // Open database
+    int rc = sqlite3_open_v2(database_path.c_str(), &db, SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX, nullptr);
     if (rc != SQLITE_OK) {
-        std::cerr << "Failed to fetch data: " << sqlite3_errmsg(db) << std::endl;
+        std::string msg = "Can't open database: " + std::string(sqlite3_errmsg(db));
         sqlite3_close(db);
-        return result;
+        db = nullptr;
+        throw std::runtime_error(msg);
     }
 
-    // Bind date parameter
-    sqlite3_bind_text(stmt, 1, date_str, -1, SQLITE_STATIC);
+    char* errmsg = nullptr;
+    if (sqlite3_exec(db, TICK_SOURCE_PRAGMAS, nullptr, nullptr, &errmsg) != SQLITE_OK) {
+        // tuning only, the queries still work without it
+        std::cerr << "Warning: failed to apply connection pragmas: " << (errmsg ? errmsg : "") << std::endl;
+        sqlite3_free(errmsg);
+    }
 
-    // Execute query and fetch results
-    while (sqlite3_step(stmt) == SQLITE_ROW) {
-        TickData tick;
-        tick.id = sqlite3_column_int(stmt, 0);
-        tick.DateTime = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
-        tick.Price = sqlite3_column_double(stmt, 2);
-        tick.AskVolume = sqlite3_column_double(stmt, 3);
-        tick.BidVolume = sqlite3_column_double(stmt, 4);
-        result.push_back(tick);
+    // Prepare SQL statements once for the whole run
+    // ties on DateTime keep the id order, which is also the order of the covering index
+    std::string daySql = "SELECT id, DateTime, Price, AskVolume, BidVolume FROM \"" +
+                         table_name +
+                         "\" WHERE DateTime >= ? AND DateTime < ? ORDER BY DateTime, id";
+    std::string firstTickSql = daySql + " LIMIT 1";
+
+    if (sqlite3_prepare_v3(db, daySql.c_str(), -1, SQLITE_PREPARE_PERSISTENT, &dayStmt, nullptr) != SQLITE_OK ||
+        sqlite3_prepare_v3(db, firstTickSql.c_str(), -1, SQLITE_PREPARE_PERSISTENT, &firstTickStmt, nullptr) != SQLITE_OK ||
+        sqlite3_prepare_v3(db, daySql.c_str(), -1, SQLITE_PREPARE_PERSISTENT, &rangeStmt, nullptr) != SQLITE_OK) {
+        std::string msg = "Failed to prepare tick query: " + std::string(sqlite3_errmsg(db));
+        sqlite3_finalize(dayStmt);
+        sqlite3_finalize(firstTickStmt);
+        sqlite3_finalize(rangeStmt);
+        sqlite3_close(db);
+        db = nullptr;
+        throw std::runtime_error(msg);
+    }
+
+    indexed = usesIndex(db, daySql);
+}
+
+
+void SqliteTickSource::createDateTimeIndex(const std::string& database_path, const std::string& table_name) {
+    sqlite3* rwdb = nullptr;
+    if (sqlite3_open_v2(database_path.c_str(), &rwdb, SQLITE_OPEN_READWRITE, nullptr) != SQLITE_OK) {
+        std::string msg = "Can't open database for indexing: " + std::string(sqlite3_errmsg(rwdb));
+        sqlite3_close(rwdb);
+        throw std::runtime_error(msg);
     }
 
+    // covering index, the day query is answered from the index pages alone
+    std::string sql = "CREATE INDEX IF NOT EXISTS \"" + tickIndexName(table_name) + "\" ON \"" + table_name +
+                      "\" (DateTime, id, Price, AskVolume, BidVolume)";
+    char* errmsg = nullptr;
+    int rc = sqlite3_exec(rwdb, sql.c_str(), nullptr, nullptr, &errmsg);
+    std::string msg = (rc != SQLITE_OK && errmsg) ? errmsg : "";
+    sqlite3_free(errmsg);
+    sqlite3_close(rwdb);
+    if (rc != SQLITE_OK) {
+        throw std::runtime_error("Failed to create DateTime index: " + msg);
+    }
+}
+
+
+SqliteTickSource::~SqliteTickSource() {
     // Clean up
-    sqlite3_finalize(stmt);
+    sqlite3_finalize(dayStmt);
+    sqlite3_finalize(firstTickStmt);
+    sqlite3_finalize(rangeStmt);
     sqlite3_close(db);
-    
-    return result;
 }
 
 
+void SqliteTickSource::fetchDay(const Date date, std::vector<TickData>& ticks) {
+    ticks.clear();
 
-//this function is to initialize the contract
-TickData fetchFirstTick(const std::string& database_path, const std::string& table_name, const Date date) {
+    sqlite3_reset(dayStmt);
+    bindDayRange(dayStmt, date, date);
+
+    // Execute query and fetch results
+    TickData tick;
+    int rc;
+    while ((rc = sqlite3_step(dayStmt)) == SQLITE_ROW) {
+        readTickRow(dayStmt, tickSize, tick);
+        ticks.push_back(tick);
+    }
+    if (rc != SQLITE_DONE) {
+        std::cerr << "Failed to fetch data: " << sqlite3_errmsg(db) << std::endl;
+    }
+
+    sqlite3_reset(dayStmt);
+}
+
+
+TickData SqliteTickSource::fetchFirstTick(const Date date) {
     TickData result = {}; // Initialize to default values
     result.id = -1; // Use -1 to indicate failure or no data found
-    sqlite3* db;
-    
-    // Open database
-    int rc = sqlite3_open(database_path.c_str(), &db);
-    if (rc) {
-        std::cerr << "Can't open database: " << sqlite3_errmsg(db) << std::endl;
-        return result;
+
+    sqlite3_reset(firstTickStmt);
+    bindDayRange(firstTickStmt, date, date);
+
+    // Execute query and fetch the first result
+    if (sqlite3_step(firstTickStmt) == SQLITE_ROW) {
+        readTickRow(firstTickStmt, tickSize, result);
     }
 
-    // Format date string YYYY-MM-DD
-    char date_str[11];
-    snprintf(date_str, sizeof(date_str), "%04d-%02d-%02d", date.y, date.m, date.d);
-
-    // Prepare SQL statement to get the first row of the day
-    std::string sql = "SELECT id, DateTime, Price, AskVolume, BidVolume FROM " + 
-                     table_name + 
-                     " WHERE strftime('%Y-%m-%d', DateTime) = ? ORDER BY DateTime ASC LIMIT 1";
-    
-    sqlite3_stmt* stmt;
-    rc = sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr);
-    
-    if (rc != SQLITE_OK) {
+    sqlite3_reset(firstTickStmt);
+    return result;
+}
+
+
+
+void SqliteTickSource::openRange(const Date from, const Date to) {
+    sqlite3_reset(rangeStmt);
+    bindDayRange(rangeStmt, from, to);
+}
+
+
+bool SqliteTickSource::nextTick(TickData& tick) {
+    int rc = sqlite3_step(rangeStmt);
+    if (rc == SQLITE_ROW) {
+        readTickRow(rangeStmt, tickSize, tick);
+        return true;
+    }
+    if (rc != SQLITE_DONE) {
         std::cerr << "Failed to fetch data: " << sqlite3_errmsg(db) << std::endl;
-        sqlite3_close(db);
-        return result;
     }
+    sqlite3_reset(rangeStmt);
+    return false;
+}
 
-    // Bind date parameter
-    sqlite3_bind_text(stmt, 1, date_str, -1, SQLITE_STATIC);
 
-    // Execute query and fetch the first result
-    if (sqlite3_step(stmt) == SQLITE_ROW) {
-        result.id = sqlite3_column_int(stmt, 0);
-        result.DateTime = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
-        result.Price = sqlite3_column_double(stmt, 2);
-        result.AskVolume = sqlite3_column_double(stmt, 3);
-        result.BidVolume = sqlite3_column_double(stmt, 4);
+
+// one-shot helpers, a SqliteTickSource should be preferred when more than one day is read
+std::vector<TickData> fetchData(const std::string& database_path, const std::string& table_name, const Date date, double tickSize) {
+    std::vector<TickData> result;
+    try {
+        SqliteTickSource source(database_path, table_name, tickSize);
+        source.fetchDay(date, result);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
     }
+    return result;
+}
 
-    // Clean up
-    sqlite3_finalize(stmt);
-    sqlite3_close(db);
-    
+
+
+//this function is to initialize the contract
+TickData fetchFirstTick(const std::string& database_path, const std::string& table_name, const Date date, double tickSize) {
+    try {
+        SqliteTickSource source(database_path, table_name, tickSize);
+        return source.fetchFirstTick(date);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+    }
+    TickData result = {};
+    result.id = -1;
     return result;
 }
@@ -0,0 +1,192 @@
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstring>
+#include <cstddef>
+#include <stdexcept>
+#include <algorithm>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "database.h"
+#include "tick_cache_format.h"
+#include "../tickTime.h"
+
+
+// the mapped records are handed to the engine as TickData, so both layouts must agree field by field
+static_assert(sizeof(TickCacheRecord) == sizeof(TickData), "tick cache record and TickData differ in size");
+static_assert(offsetof(TickCacheRecord, dateTimeNs) == offsetof(TickData, DateTimeNs), "tick cache layout mismatch");
+static_assert(offsetof(TickCacheRecord, priceTicks) == offsetof(TickData, PriceTicks), "tick cache layout mismatch");
+static_assert(offsetof(TickCacheRecord, askVolume) == offsetof(TickData, AskVolume), "tick cache layout mismatch");
+static_assert(offsetof(TickCacheRecord, bidVolume) == offsetof(TickData, BidVolume), "tick cache layout mismatch");
+static_assert(offsetof(TickCacheRecord, id) == offsetof(TickData, id), "tick cache layout mismatch");
+
+
+namespace {
+
+// the days must be sorted by epochDay and cover the records front to back without gaps or overlaps,
+// records() relies on both for lower_bound and to cut one contiguous subspan
+bool indexIsValid(std::span<const TickCacheDay> days, uint64_t recordCount) {
+    uint64_t next = 0;
+    for (size_t i = 0; i < days.size(); ++i) {
+        const TickCacheDay& day = days[i];
+        if (day.first != next || day.count > recordCount - next ||
+            (i > 0 && day.epochDay <= days[i - 1].epochDay)) {
+            return false;
+        }
+        next += day.count;
+    }
+    return next == recordCount;
+}
+
+
+class TickCacheSource : public TickSource {
+public:
+    TickCacheSource(const std::string& path, double tickSize);
+    ~TickCacheSource() override;
+
+    TickCacheSource(const TickCacheSource&) = delete;
+    TickCacheSource& operator=(const TickCacheSource&) = delete;
+
+    void fetchDay(const Date date, std::vector<TickData>& ticks) override;
+    std::span<const TickData> dayView(const Date date, std::vector<TickData>& buffer) override;
+    TickData fetchFirstTick(const Date date) override;
+    void openRange(const Date from, const Date to) override;
+    bool nextTick(TickData& tick) override;
+
+private:
+    // records of [first day, last day] straight from the mapping, empty if the range has no data
+    std::span<const TickData> records(int64_t firstDay, int64_t lastDay) const;
+
+    void* mapping = MAP_FAILED;
+    size_t mappingSize = 0;
+    std::span<const TickData> ticks;
+    std::span<const TickCacheDay> days;
+
+    // state of the open range
+    const TickData* rangePos = nullptr;
+    const TickData* rangeEnd = nullptr;
+};
+
+
+TickCacheSource::TickCacheSource(const std::string& path, double tickSize) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Can't open tick cache: " + path);
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(TickCacheHeader)) {
+        close(fd);
+        throw std::runtime_error("Tick cache is truncated: " + path);
+    }
+    mappingSize = static_cast<size_t>(st.st_size);
+    mapping = mmap(nullptr, mappingSize, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("Can't map tick cache: " + path);
+    }
+
+    const auto* base = static_cast<const unsigned char*>(mapping);
+    TickCacheHeader header;
+    std::memcpy(&header, base, sizeof(header));
+
+    std::string error;
+    if (std::memcmp(header.magic, TICK_CACHE_MAGIC, sizeof(header.magic)) != 0) {
+        error = "not a tick cache file";
+    } else if (header.version != TICK_CACHE_VERSION || header.recordSize != sizeof(TickCacheRecord)) {
+        error = "unsupported tick cache version";
+    } else if (header.tickSize != tickSize) {
+        error = "tick cache was written with tick size " + std::to_string(header.tickSize);
+    } else if (header.recordsOffset + header.recordCount * sizeof(TickCacheRecord) > mappingSize ||
+               header.indexOffset + header.dayCount * sizeof(TickCacheDay) > mappingSize ||
+               header.recordsOffset % alignof(TickData) != 0 || header.indexOffset % alignof(TickCacheDay) != 0) {
+        error = "tick cache is truncated";
+    } else {
+        days = std::span<const TickCacheDay>(reinterpret_cast<const TickCacheDay*>(base + header.indexOffset), header.dayCount);
+        if (!indexIsValid(days, header.recordCount)) {
+            error = "tick cache index is corrupt";
+        }
+    }
+    if (!error.empty()) {
+        munmap(mapping, mappingSize);
+        mapping = MAP_FAILED;
+        throw std::runtime_error(error + ": " + path);
+    }
+
+    ticks = std::span<const TickData>(reinterpret_cast<const TickData*>(base + header.recordsOffset), header.recordCount);
+
+    // the engine walks the file front to back
+    madvise(mapping, mappingSize, MADV_SEQUENTIAL);
+}
+
+
+TickCacheSource::~TickCacheSource() {
+    if (mapping != MAP_FAILED) {
+        munmap(mapping, mappingSize);
+    }
+}
+
+
+std::span<const TickData> TickCacheSource::records(int64_t firstDay, int64_t lastDay) const {
+    // days are sorted, so the range is one contiguous run of records
+    auto begin = std::lower_bound(days.begin(), days.end(), firstDay,
+                                  [](const TickCacheDay& day, int64_t value) { return day.epochDay < value; });
+    auto end = std::upper_bound(begin, days.end(), lastDay,
+                                [](int64_t value, const TickCacheDay& day) { return value < day.epochDay; });
+    if (begin == end) {
+        return {};
+    }
+    const auto& last = *(end - 1);
+    return ticks.subspan(begin->first, last.first + last.count - begin->first);
+}
+
+
+std::span<const TickData> TickCacheSource::dayView(const Date date, std::vector<TickData>& /*buffer*/) {
+    const int64_t day = dateToNs(date) / TICK_CACHE_NS_PER_DAY;
+    return records(day, day);
+}
+
+
+void TickCacheSource::fetchDay(const Date date, std::vector<TickData>& ticks) {
+    std::vector<TickData> unused;
+    std::span<const TickData> view = dayView(date, unused);
+    ticks.assign(view.begin(), view.end());
+}
+
+
+TickData TickCacheSource::fetchFirstTick(const Date date) {
+    std::vector<TickData> unused;
+    std::span<const TickData> view = dayView(date, unused);
+    if (view.empty()) {
+        TickData result = {};
+        result.id = -1; // Use -1 to indicate failure or no data found
+        return result;
+    }
+    return view.front();
+}
+
+
+void TickCacheSource::openRange(const Date from, const Date to) {
+    std::span<const TickData> view = records(dateToNs(from) / TICK_CACHE_NS_PER_DAY, dateToNs(to) / TICK_CACHE_NS_PER_DAY);
+    rangePos = view.data();
+    rangeEnd = view.data() + view.size();
+}
+
+
+bool TickCacheSource::nextTick(TickData& tick) {
+    if (rangePos == rangeEnd) {
+        return false;
+    }
+    tick = *rangePos++;
+    return true;
+}
+
+} // namespace
+
+
+std::unique_ptr<TickSource> openTickCacheSource(const std::string& path, double tickSize) {
+    return std::make_unique<TickCacheSource>(path, tickSize);
+}
@@ -0,0 +1,46 @@
+#ifndef TICK_CACHE_FORMAT_H
+#define TICK_CACHE_FORMAT_H
+
+#include <cstdint>
+
+// flat binary tick cache, written by `data_cleaner --tick-cache` and memory mapped by footprint_trainer
+// layout: TickCacheHeader | recordCount x TickCacheRecord | dayCount x TickCacheDay
+// records keep the id order of the source table and every day is one contiguous run of records, so a day is (first, count).
+// the structs are stored in native byte order, a cache is meant for the machine (or architecture) that wrote it
+// this header is shared by both projects, keep it free of anything but <cstdint>
+
+inline constexpr char TICK_CACHE_MAGIC[8] = {'F', 'P', 'T', 'I', 'C', 'K', 'S', '\0'};
+inline constexpr uint32_t TICK_CACHE_VERSION = 1;
+inline constexpr int64_t TICK_CACHE_NS_PER_DAY = 86400LL * 1000000000LL;
+
+struct TickCacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t recordSize;     // sizeof(TickCacheRecord), guards against layout changes
+    double tickSize;         // price of one tick, priceTicks * tickSize is the traded price
+    uint64_t recordCount;
+    uint64_t dayCount;
+    uint64_t recordsOffset;  // byte offset of the first record
+    uint64_t indexOffset;    // byte offset of the first TickCacheDay
+};
+
+// same layout as the engine's TickData so a mapped day can be iterated in place
+struct TickCacheRecord {
+    int64_t dateTimeNs;      // ns since epoch of the (New York local, timezone naive) tick time
+    int32_t priceTicks;
+    int32_t askVolume;
+    int32_t bidVolume;
+    int32_t id;
+};
+
+struct TickCacheDay {
+    int64_t epochDay;        // dateTimeNs / TICK_CACHE_NS_PER_DAY of every record of the day
+    uint64_t first;          // index of the first record of the day
+    uint64_t count;
+};
+
+static_assert(sizeof(TickCacheHeader) == 56, "TickCacheHeader layout changed, bump TICK_CACHE_VERSION");
+static_assert(sizeof(TickCacheRecord) == 24, "TickCacheRecord layout changed, bump TICK_CACHE_VERSION");
+static_assert(sizeof(TickCacheDay) == 24, "TickCacheDay layout changed, bump TICK_CACHE_VERSION");
+
+#endif // TICK_CACHE_FORMAT_H
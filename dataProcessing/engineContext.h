@@ -0,0 +1,97 @@
+#ifndef ENGINE_CONTEXT_H
+#define ENGINE_CONTEXT_H
+
+#include "dataStructure.h"
+
+
+// the levels the price features of a bar are measured against, as prices.
+// they only move at bar close and at a new day, so they are copied there once instead of being
+// re-read and re-converted on every price change. levels of a missing previous day/week are NaN
+struct PriceReferenceLevels {
+    double dayVwap = 0.0;
+    double dayVwapUpperStdDev1 = 0.0;
+    double dayVwapUpperStdDev2 = 0.0;
+    double dayVwapLowerStdDev1 = 0.0;
+    double dayVwapLowerStdDev2 = 0.0;
+    double weekVwap = 0.0;
+    double weekVwapUpperStdDev1 = 0.0;
+    double weekVwapLowerStdDev1 = 0.0;
+    double bbUpper = 0.0;
+    double bbLower = 0.0;
+    double bbMiddle = 0.0;
+    double dayVAH = 0.0;
+    double dayVAL = 0.0;
+    int32_t dayVahTicks = 0;
+    int32_t dayValTicks = 0;
+    double ibHigh = 0.0;
+    double ibLow = 0.0;
+    double weekHigh = 0.0;
+    double weekLow = 0.0;
+
+    bool hasPrevDay = false;
+    double prevDayVwap = 0.0;
+    double prevDayVAH = 0.0;
+    double prevDayVAL = 0.0;
+    double prevDayPOC = 0.0;
+    int32_t prevDayVahTicks = 0;
+    int32_t prevDayValTicks = 0;
+    double prevDayHigh = 0.0;
+    double prevDayLow = 0.0;
+    double prevDayClose = 0.0;
+    double prevWeekHigh = 0.0;
+    double prevWeekLow = 0.0;
+};
+
+
+// handles to the parts of the contract the engine is currently writing, so the per tick code does not
+// walk contract.weeks.back().days.back().bars.back() again on every access.
+// the handles point into the contract's vectors and are only refreshed at boundaries:
+// refresh() after a week or a day was added, refreshBar() after a bar was added.
+// a context only touches its own contract, so one context per thread is safe
+struct EngineContext {
+    explicit EngineContext(Contract& contract) : contract(contract) { refresh(); }
+
+    Contract& contract;
+    Week* week = nullptr;       // current week
+    Day* day = nullptr;         // current day, nullptr until the week's first day is added
+    Bar* bar = nullptr;         // current bar of the current day
+    BarFeatures* features = nullptr; // cold price features of the current bar
+    Day* prevDay = nullptr;     // day before the current one (the last day of an earlier week on a week's first day), nullptr on the first day
+    Week* prevWeek = nullptr;   // last earlier week with data, nullptr in the first week
+
+    // price features of the bar (see updatePriceSensitiveFeatures)
+    bool lazyPriceFeatures = false;     // derive the bar's price features at bar close or on a signal instead of on every price change
+    PriceReferenceLevels levels;        // taken by snapshotPriceReferences at bar close and at a new day
+    bool featuresPending = false;       // lazy mode: the current bar's features are behind its last price change
+    int32_t pendingTicks = 0;           // lazy mode: price of that last price change
+
+    void refresh() {
+        week = &contract.weeks.back();
+        day = week->days.empty() ? nullptr : &week->days.back();
+
+        prevDay = nullptr;
+        prevWeek = nullptr;
+        if (week->days.size() >= 2) {
+            prevDay = &week->days[week->days.size() - 2];
+        }
+        for (size_t w = contract.weeks.size() - 1; w-- > 0;) {
+            Week& earlier = contract.weeks[w];
+            if (earlier.days.empty()) {
+                continue;   // weeks without data still roll over
+            }
+            prevWeek = &earlier;
+            if (!prevDay) {
+                prevDay = &earlier.days.back();
+            }
+            break;
+        }
+        refreshBar();
+    }
+
+    void refreshBar() {
+        bar = (day && !day->bars.empty()) ? &day->bars.back() : nullptr;
+        features = bar ? &day->barFeatures.back() : nullptr;
+    }
+};
+
+#endif // ENGINE_CONTEXT_H
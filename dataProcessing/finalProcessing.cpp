@@ -5,17 +5,117 @@
 #include <chrono>
 #include <ctime>
 #include <iostream>
+#include <cmath>
 #include "dataStructure.h"
 #include "database/database.h"
+#include "convertDatesToWeek.h"
+#include "tickTime.h"
 #include "src/updatefeatures.h"
 
-extern void initializeNewDay(Contract& contract, double firstPrice, int dayOfWeek);
+extern void initializeNewDay(EngineContext& ctx, int32_t firstTicks, int dayOfWeek);
 
 
 
+// feeds a single tick of the current day into the current bar
+// prices stay in ticks, bar_range_ticks is the bar range as a whole number of ticks
+static void processTick(int32_t bar_range_ticks, double imbalanceThreshhold, EngineContext& ctx, const TickData& row) {
+    // std::cout << "st"
+    int32_t currentTicks = row.PriceTicks;
+    int currentAskVolume = row.AskVolume;
+    int currentBidVolume = row.BidVolume;
+    int64_t currentTime = row.DateTimeNs;
+
+    // the bar the tick lands in unless it opens a new one (the handle is stale after initializeNewBar)
+    Bar& BAR = *ctx.bar;
+    int32_t lastHigh = BAR.highTicks;
+    int32_t lastLow = BAR.lowTicks;
+
+    // check if the price is in the range of the current bar, this due to the fact that we are processing chart in ranged bar
+    if (lastHigh - currentTicks <= bar_range_ticks && currentTicks - lastLow <= bar_range_ticks )  {          //if price is in the range so only updation of the bar
+        if (currentTicks != BAR.closeTicks) {           //if price changed
+            // updating bar's ohlc
+            BAR.closeTicks = currentTicks;
+            BAR.highTicks = std::max(lastHigh, currentTicks);
+            BAR.lowTicks = std::min(lastLow, currentTicks);
+            BAR.endTime = currentTime;
+
+            // update footprint bar
+            auto imbalance_change = updateFootprint(ctx, imbalanceThreshhold, currentTicks, currentAskVolume, currentBidVolume);
+
+            checkForSignal(ctx);      //check for signal
+            // if signal
+                //update all
+                // append to signal data structure
+
+            // update tick change sensitive features
+            updateTickSensitiveFeatures(ctx, currentTicks, currentAskVolume, currentBidVolume, imbalance_change);
+
+            // update price change sensitive feartures
+            updatePriceSensitiveFeatures(ctx, currentTicks, currentAskVolume, currentBidVolume);
+        }
+
+        else  {         //else price not changed
+            // update footprint bar
+            auto imbalance_change = updateFootprint(ctx, imbalanceThreshhold, currentTicks, currentAskVolume, currentBidVolume);
+
+            checkForSignal(ctx);      //check for signal
+                // if signal
+                    //update all
+                    // append to signal data structure
+
+            // update tick change sensitive features
+            updateTickSensitiveFeatures(ctx, currentTicks, currentAskVolume, currentBidVolume, imbalance_change);
+
+        }
+    }
+    else {           //else price not in the range, so we need to create new bar
+        // finalize the last bar and update bar change sensitive features
+        // and add new bar in the bars vector of the currect processing day's data structure
+        updateBarChangeSensitiveFeatures(ctx, currentTicks, currentAskVolume, currentBidVolume);
+        initializeNewBar(ctx, currentTime, currentTicks, currentAskVolume, currentBidVolume);
+
+        // update footprint bar
+        auto imbalance_change = updateFootprint(ctx, imbalanceThreshhold, currentTicks, currentAskVolume, currentBidVolume);
+
+        // update tick change sensitive features
+        updateTickSensitiveFeatures(ctx, currentTicks, currentAskVolume, currentBidVolume, imbalance_change);
+
+        // update price change sensitive feartures
+        updatePriceSensitiveFeatures(ctx, currentTicks, currentAskVolume, currentBidVolume);
+
+
+    }
+}
+
+
+static void finishDay(EngineContext& ctx) {
+    // finalize the processing_day and update day change sensitive features
+    updateDayChangeSensitiveFeatures(ctx);
+    // finalizeProcessingDay(ctx);
+    std::cout <<"day processing finished" << std::endl;
+}
+
+
+static void finishWeek(EngineContext& ctx) {
+    // finalize the processing_week and update week change sensitive features
+    std::cout <<"week processing finished" << std::endl;
+    updateWeekChangeSensitiveFeatures(ctx);
+    initializeWeek(ctx);
+}
+
+
+
+// this function will take inputs contract and the weekVector and the tick source of the run
+void finalProcessing(double bar_range, double imbalanceThreshhold, Contract& contract , std::vector<weekVector>& weeksVector, TickSource& tickSource, bool lazyPriceFeatures) {
+    // rounded once, 0.3 / 0.1 is 2.9999999999999996 and would close every bar one tick early
+    const int32_t bar_range_ticks = static_cast<int32_t>(std::llround(bar_range / contract.instrument.tickSize));
+    // handles to the current week/day/bar, refreshed by the initialize functions at every boundary
+    EngineContext ctx(contract);
+    ctx.lazyPriceFeatures = lazyPriceFeatures;
+    // one day buffer reused for every day so its capacity is only grown on the busiest day
+    // (sources that keep the day in memory hand out a view instead and leave it empty)
+    std::vector<TickData> processing_day_data;
 
-// this function will take inputs contract and the weekVector and database path
-void finalProcessing(double bar_range, double imbalanceThreshhold, Contract& contract , std::vector<weekVector>& weeksVector, const std::string& database_path, const std::string& table_name) {
     // start itteration on the weeksVector
     for (const auto& processing_week : weeksVector) {
         // the start new loop for days in that processing_week
@@ -28,100 +128,102 @@ void finalProcessing(double bar_range, double imbalanceThreshhold, Contract& con
                 processing_day.date.m,
                 processing_day.date.d
             };
-            std::vector<TickData> processing_day_data = fetchData(database_path, table_name, processing_date);
-            std::cout << "starting processing data for :" << processing_date.y << "-" << processing_date.m << "-" << processing_date.d << "  datasize:" << processing_day_data.size() << "\n";               
+            std::span<const TickData> processing_day_ticks = tickSource.dayView(processing_date, processing_day_data);
+            std::cout << "starting processing data for :" << processing_date.y << "-" << processing_date.m << "-" << processing_date.d << "  datasize:" << processing_day_ticks.size() << "\n";
 
             // initialising new day with values
-            if (processing_day_data.empty()) {
+            if (processing_day_ticks.empty()) {
                 std::cout << "No data found for the day" << std::endl;
                 continue;
             }
             else{
-                initializeNewDay(contract, processing_day_data.front().Price, processing_day.dayNumber);
+                initializeNewDay(ctx, processing_day_ticks.front().PriceTicks, processing_day.dayNumber);
                 std::cout << "new day initializes, and starting populating the data to the new day struct" << std::endl;
             }
 
                 // start new main data processing loop iterating through each row of the fetch data
-            for (const auto& row : processing_day_data) {
-                if (processing_day_data.empty()) {
-                    std::cout << "No data found for date: " << processing_date.y << "-" << processing_date.m << "-" << processing_date.d << std::endl;
-                    continue; // Skip to the next day if no data is found
-                }
-                // std::cout << "st"
-                double currentPrice = row.Price;
-                int currentAskVolume = row.AskVolume;
-                int currentBidVolume = row.BidVolume;
-                std::string currentTime = row.DateTime;
-
-                double lastHigh = contract.weeks.back().days.back().bars.back().high;
-                double lastLow = contract.weeks.back().days.back().bars.back().low;
-            
-                // check if the price is in the range of the current bar, this due to the fact that we are processing chart in ranged bar
-                if (lastHigh - currentPrice <= bar_range && currentPrice - lastLow <= bar_range )  {          //if price is in the range so only updation of the bar
-                    if (currentPrice != contract.weeks.back().days.back().bars.back().close) {           //if price changed
-                        // updating bar's ohlc
-                        contract.weeks.back().days.back().bars.back().close = currentPrice;
-                        contract.weeks.back().days.back().bars.back().high = std::max(lastHigh, currentPrice);
-                        contract.weeks.back().days.back().bars.back().low = std::min(lastLow, currentPrice);
-                        contract.weeks.back().days.back().bars.back().endTime = currentTime;
-
-                        // update footprint bar
-                        auto imbalance_change = updateFootprint(contract, imbalanceThreshhold, currentPrice, currentAskVolume, currentBidVolume);
-
-                        checkForSignal(contract);      //check for signal
-                        // if signal 
-                            //update all
-                            // append to signal data structure
-
-                        // update tick change sensitive features
-                        updateTickSensitiveFeatures(contract, currentPrice, currentAskVolume, currentBidVolume, imbalance_change);
-
-                        // update price change sensitive feartures
-                        updatePriceSensitiveFeatures(contract, currentPrice, currentAskVolume, currentBidVolume);
-                    }    
-
-                    else  {         //else price not changed
-                        // update footprint bar
-                        auto imbalance_change = updateFootprint(contract, imbalanceThreshhold, currentPrice, currentAskVolume, currentBidVolume);
-
-                        checkForSignal(contract);      //check for signal
-                            // if signal
-                                //update all
-                                // append to signal data structure
-
-                        // update tick change sensitive features
-                        updateTickSensitiveFeatures(contract, currentPrice, currentAskVolume, currentBidVolume, imbalance_change);
-
-                    }
-                }
-                else {           //else price not in the range, so we need to create new bar
-                    // finalize the last bar and update bar change sensitive features
-                    // and add new bar in the bars vector of the currect processing day's data structure
-                    updateBarChangeSensitiveFeatures(contract, currentPrice, currentAskVolume, currentBidVolume);
-                    initializeNewBar(contract, currentTime, currentPrice, currentAskVolume, currentBidVolume);
-                    
-                    // update footprint bar
-                    auto imbalance_change = updateFootprint(contract, imbalanceThreshhold, currentPrice, currentAskVolume, currentBidVolume);
-
-                    // update tick change sensitive features
-                    updateTickSensitiveFeatures(contract, currentPrice, currentAskVolume, currentBidVolume, imbalance_change);
-
-                    // update price change sensitive feartures
-                    updatePriceSensitiveFeatures(contract, currentPrice, currentAskVolume, currentBidVolume);
-
-
-                }
+            for (const auto& row : processing_day_ticks) {
+                processTick(bar_range_ticks, imbalanceThreshhold, ctx, row);
             }
-            // finalize the processing_day and update day change sensitive features
-            updateDayChangeSensitiveFeatures(contract);
-            // finalizeProcessingDay(contract);
-            std::cout <<"day processing finished" << std::endl;
+            finishDay(ctx);
         }
-        // finalize the processing_week and update week change sensitive features
-        std::cout <<"week processing finished" << std::endl;
-        updateWeekChangeSensitiveFeatures(contract);
-        initializeWeek(contract);
+        finishWeek(ctx);
+
+    }
+    // finalize the contract
+    finalizeContract(contract);
+}
+
+
+
+static bool sameDate(const Date& a, const Date& b) {
+    return a.y == b.y && a.m == b.m && a.d == b.d;
+}
+
+
+// streaming variant of finalProcessing
+// a single ordered cursor covers the whole date range and ticks are pushed straight into the engine,
+// day and week boundaries are detected from the tick timestamps as they arrive so no day is ever buffered.
+// weeks and days are finalized exactly like the day by day loop above (weeks without data still roll over)
+void finalProcessingStream(double bar_range, double imbalanceThreshhold, Contract& contract , std::vector<weekVector>& weeksVector, TickSource& tickSource, bool lazyPriceFeatures) {
+    // rounded once, 0.3 / 0.1 is 2.9999999999999996 and would close every bar one tick early
+    const int32_t bar_range_ticks = static_cast<int32_t>(std::llround(bar_range / contract.instrument.tickSize));
+    // handles to the current week/day/bar, refreshed by the initialize functions at every boundary
+    EngineContext ctx(contract);
+    ctx.lazyPriceFeatures = lazyPriceFeatures;
+    if (weeksVector.empty()) {
+        finalizeContract(contract);
+        return;
+    }
+
+    size_t weekIndex = 0;
+    bool dayOpen = false;
+    Date currentDate = {0, 0, 0};
 
+    std::cout <<"starting for the week : " << weeksVector[weekIndex].weekNumber <<std::endl;
+    tickSource.openRange(weeksVector.front().startDate, weeksVector.back().endDate);
+
+    TickData row;
+    while (tickSource.nextTick(row)) {
+        Date date = dateFromNs(row.DateTimeNs);
+        if (dayOpen && sameDate(date, currentDate)) {
+            processTick(bar_range_ticks, imbalanceThreshhold, ctx, row);
+            continue;
+        }
+
+        // day boundary
+        if (dayOpen) {
+            finishDay(ctx);
+        }
+
+        // week boundary, every calendar week up to the tick's week is rolled over
+        while (weekIndex + 1 < weeksVector.size() && weeksVector[weekIndex].endDate < date) {
+            finishWeek(ctx);
+            ++weekIndex;
+            std::cout <<"starting for the week : " << weeksVector[weekIndex].weekNumber <<std::endl;
+        }
+
+        int dayNumber = 0;
+        for (const auto& entry : weeksVector[weekIndex].days) {
+            if (sameDate(entry.date, date)) {
+                dayNumber = entry.dayNumber;
+                break;
+            }
+        }
+
+        currentDate = date;
+        dayOpen = true;
+        std::cout << "starting processing data for :" << date.y << "-" << date.m << "-" << date.d << "\n";
+        initializeNewDay(ctx, row.PriceTicks, dayNumber);
+        processTick(bar_range_ticks, imbalanceThreshhold, ctx, row);
+    }
+
+    if (dayOpen) {
+        finishDay(ctx);
+    }
+    // the remaining (possibly empty) weeks of the range
+    for (; weekIndex < weeksVector.size(); ++weekIndex) {
+        finishWeek(ctx);
     }
     // finalize the contract
     finalizeContract(contract);
@@ -5,25 +5,25 @@
 
 
 
-void initializeContract(Contract& contract, const std::string& database_path, const std::string& table_name, const Date& startDate) {
+void initializeContract(Contract& contract, TickSource& tickSource, const Date& startDate) {
     // Fetch the first tick data for the start date
-    TickData tickData = fetchFirstTick(database_path, table_name, startDate);
+    TickData tickData = tickSource.fetchFirstTick(startDate);
 
     if (tickData.id == -1) {
         throw std::runtime_error("No data found for the given start date.");
     }
 
-    double initialPrice = tickData.Price;
+    int32_t initialTicks = tickData.PriceTicks;
 
 
     // Initialize price-related fields in Week
     Week initialWeek;
-    initialWeek.vwap = initialPrice;
-    initialWeek.poc = initialPrice;
-    initialWeek.vah = initialPrice;
-    initialWeek.val = initialPrice;
-    initialWeek.weekHigh = initialPrice;
-    initialWeek.weekLow = initialPrice;
+    initialWeek.vwap = contract.instrument.toPrice(initialTicks);
+    initialWeek.pocTicks = initialTicks;
+    initialWeek.vahTicks = initialTicks;
+    initialWeek.valTicks = initialTicks;
+    initialWeek.weekHighTicks = initialTicks;
+    initialWeek.weekLowTicks = initialTicks;
 
     // Add the initialized day to the week
     // initialWeek.days.push_back(initialDay);
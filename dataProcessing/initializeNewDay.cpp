@@ -1,56 +1,69 @@
-#include "dataStructure.h"
+#include "engineContext.h"
 #include "database/database.h"
+#include "src/updatefeatures.h"
 #include <stdexcept>
 #include <cmath>
 
 
 
-void initializeNewDay(Contract& contract, double firstPrice, int dayOfWeek){
+void initializeNewDay(EngineContext& ctx, int32_t firstTicks, int dayOfWeek){
     
-    auto& WEEK = contract.weeks.back();
+    auto& WEEK = *ctx.week;
+    const double firstPrice = ctx.contract.instrument.toPrice(firstTicks);
 
     
 
     Day newDay;
-    newDay.dayHigh = firstPrice;
-    newDay.dayLow = firstPrice;
-    newDay.dayClose = firstPrice;
+    newDay.dayHighTicks = firstTicks;
+    newDay.dayLowTicks = firstTicks;
+    newDay.dayCloseTicks = firstTicks;
     newDay.totalVolume = 0;
     newDay.dayOfTheWeek = std::to_string(dayOfWeek);
     newDay.vwap = firstPrice;
-    newDay.poc = firstPrice;
-    newDay.vah = firstPrice;
-    newDay.val = firstPrice;
-    newDay.dayHigh = firstPrice;
-    newDay.dayLow = firstPrice;
-    newDay.dayClose = firstPrice;
+    newDay.pocTicks = firstTicks;
+    newDay.vahTicks = firstTicks;
+    newDay.valTicks = firstTicks;
+    newDay.dayHighTicks = firstTicks;
+    newDay.dayLowTicks = firstTicks;
+    newDay.dayCloseTicks = firstTicks;
     newDay.cumulativeDelta = 0;
-    newDay.lastSwingHigh = 0;
-    newDay.lastSwingLow = 0;
+    newDay.lastSwingHighTicks = 0;
+    newDay.lastSwingLowTicks = 0;
     newDay.bbMiddle = firstPrice;
     newDay.bbUpper = firstPrice;
     newDay.bbLower = firstPrice;
     newDay.variance = 0.0;
 
+    // the prior sessions are fixed for the whole day, the composite is taken once
+    const CompositeProfile composite = ctx.contract.sessionProfiles.lastSessions(COMPOSITE_SESSIONS);
+    newDay.compositePocTicks = composite.pocTicks;
+    newDay.compositeVahTicks = composite.vahTicks;
+    newDay.compositeValTicks = composite.valTicks;
+
 
 
 
 
     Bar newBar;
-    newBar.startTime = "-1";
-    newBar.endTime = "-1";
-    newBar.open = firstPrice;
-    newBar.close = firstPrice;
-    newBar.high = firstPrice;
-    newBar.low = firstPrice;
+    newBar.startTime = NO_TIME;
+    newBar.endTime = NO_TIME;
+    newBar.openTicks = firstTicks;
+    newBar.closeTicks = firstTicks;
+    newBar.highTicks = firstTicks;
+    newBar.lowTicks = firstTicks;
     newBar.barTotalVolume = 0;
 
 
 
     newDay.bars.push_back(newBar);
+    newDay.barFeatures.emplace_back();
     WEEK.days.push_back(newDay);
+    ctx.refresh();
+
+    if (WEEK.weekLowTicks == 0){WEEK.weekLowTicks = firstTicks;}
 
-    if (WEEK.weekLow == 0.0){WEEK.weekLow = firstPrice;}
+    // the levels the price features of the day's first bar are measured against
+    snapshotPriceReferences(ctx);
     
 
 
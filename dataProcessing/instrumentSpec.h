@@ -0,0 +1,51 @@
+#ifndef INSTRUMENT_SPEC_H
+#define INSTRUMENT_SPEC_H
+
+#include <cstdint>
+#include <cmath>
+#include <string>
+
+// contract constants of the traded instrument
+// the engine carries every traded price level (ohlc, footprint, profile levels) as an int32 number of ticks,
+// prices only become doubles for the real valued indicators (vwap, bands, ...) and at export
+struct InstrumentSpec {
+    const char* symbol;
+    double tickSize;          // price of one tick
+    double pointValue;        // currency value of a 1.0 price move of one contract
+    int sessionOpenMinutes;   // regular session open, New York time in minutes past midnight
+    int sessionCloseMinutes;  // regular session close, New York time in minutes past midnight
+
+    int32_t toTicks(double price) const { return static_cast<int32_t>(std::llround(price / tickSize)); }
+    double toPrice(int32_t ticks) const { return ticks * tickSize; }
+    double tickValue() const { return tickSize * pointValue; }
+};
+
+
+// the contracts the engine is set up for, looked up by the root symbol of the table
+inline constexpr InstrumentSpec INSTRUMENTS[] = {
+    {"ES",  0.25,     50.0,   9 * 60 + 30, 16 * 60},
+    {"MES", 0.25,     5.0,    9 * 60 + 30, 16 * 60},
+    {"NQ",  0.25,     20.0,   9 * 60 + 30, 16 * 60},
+    {"MNQ", 0.25,     2.0,    9 * 60 + 30, 16 * 60},
+    {"YM",  1.0,      5.0,    9 * 60 + 30, 16 * 60},
+    {"RTY", 0.1,      50.0,   9 * 60 + 30, 16 * 60},
+    {"CL",  0.01,     1000.0, 9 * 60,      14 * 60 + 30},
+    {"GC",  0.1,      100.0,  8 * 60 + 20, 13 * 60 + 30},
+    {"ZN",  0.015625, 1000.0, 8 * 60 + 20, 15 * 60},
+};
+
+// ES is the default instrument of the engine
+inline constexpr const InstrumentSpec& ES_SPEC = INSTRUMENTS[0];
+
+
+// spec of the given root symbol (e.g. "NQ"), nullptr if the engine has no spec for it
+inline const InstrumentSpec* findInstrument(const std::string& symbol) {
+    for (const auto& spec : INSTRUMENTS) {
+        if (symbol == spec.symbol) {
+            return &spec;
+        }
+    }
+    return nullptr;
+}
+
+#endif // INSTRUMENT_SPEC_H
@@ -2,6 +2,7 @@
 #include <vector>
 #include <string>
 #include <sstream>
+#include <cmath>
 #include "dataStructure.h"
 #include "database/json_writer.h"
 #include "convertDatesToWeek.h"
@@ -9,16 +10,26 @@
 #include "database/json_writer.h"
 
 #include <chrono>
+#include <memory>
+#include <filesystem>
 
-extern void initializeContract(Contract& contract, const std::string& database_path, const std::string& table_name, const Date& startDate);
-extern void finalProcessing(double bar_range, double imbalanceThreshhold, Contract& contract , std::vector<weekVector>& weeksVector, const std::string& database_path, const std::string& table_name);
+extern void initializeContract(Contract& contract, TickSource& tickSource, const Date& startDate);
+extern void finalProcessing(double bar_range, double imbalanceThreshhold, Contract& contract , std::vector<weekVector>& weeksVector, TickSource& tickSource, bool lazyPriceFeatures);
+extern void finalProcessingStream(double bar_range, double imbalanceThreshhold, Contract& contract , std::vector<weekVector>& weeksVector, TickSource& tickSource, bool lazyPriceFeatures);
 
 //test usage: ./footprint_trainer <bar_range> <database_path> <table_name> <start_date> <end_date> <output_directory> <imbalanceThreshhold>
 //test usage: ./footprint_trainer 2.5 "/Users/sarjil/sarjil/main/footprintTradingBot/testData/converted_database.db" ESH24_tick 2024-02-13 2024-03-13 "/Users/sarjil/sarjil/main/footprintTradingBot/testData/testOutputData/" 3.0
+//<database_path> may also be a data_cleaner .parquet file or output directory, <table_name> picks the contract in it (needs FOOTPRINT_WITH_PARQUET)
+//or a .ticks binary tick cache written by `data_cleaner --tick-cache`
+//optional flags after the positional arguments:
+//  --create-index   create the covering DateTime index on the table before processing (needs write access)
+//  --stream         read the whole date range through one cursor and split days/weeks in the stream
+//  --lazy-price-features  derive the bars' price diff features at bar close (or on a signal) instead of on every price change, same output
+//  --instrument <symbol>  contract spec (tick size, point value, session) of the table, ES by default (see instrumentSpec.h)
 
 int main(int argc, char* argv[]) {
-    if (argc != 8) {
-        std::cerr << "Usage: " << argv[0] << " <bar_range> <database_path> <table_name> <start_date> <end_date> <output_directory> <imbalanceThreshhold>" << std::endl;
+    if (argc < 8) {
+        std::cerr << "Usage: " << argv[0] << " <bar_range> <database_path> <table_name> <start_date> <end_date> <output_directory> <imbalanceThreshhold> [--create-index] [--stream] [--lazy-price-features] [--instrument <symbol>]" << std::endl;
 
         return 1;
     }
@@ -30,12 +41,45 @@ int main(int argc, char* argv[]) {
     const std::string output_dir(argv[6]);
     const double imbalanceThreshhold = std::stod(argv[7]);
 
+    bool createIndex = false;
+    bool streaming = false;
+    bool lazyPriceFeatures = false;
+    const InstrumentSpec* instrument = &ES_SPEC;
+    for (int i = 8; i < argc; ++i) {
+        const std::string flag(argv[i]);
+        if (flag == "--create-index") {
+            createIndex = true;
+        } else if (flag == "--stream") {
+            streaming = true;
+        } else if (flag == "--lazy-price-features") {
+            lazyPriceFeatures = true;
+        } else if (flag == "--instrument" && i + 1 < argc) {
+            instrument = findInstrument(argv[++i]);
+            if (!instrument) {
+                std::cerr << "Unknown instrument: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else {
+            std::cerr << "Unknown option: " << flag << std::endl;
+            return 1;
+        }
+    }
+
+    // the engine compares prices in whole ticks, so the bar range has to be one
+    const double rangeTicks = bar_range / instrument->tickSize;
+    if (std::llround(rangeTicks) <= 0 || std::abs(rangeTicks - std::llround(rangeTicks)) > 1e-6) {
+        std::cerr << "Bar range " << bar_range << " is not a whole number of " << instrument->symbol
+                  << " ticks (tick size " << instrument->tickSize << ")" << std::endl;
+        return 1;
+    }
+
     std::cout << "Bar range: " << bar_range << std::endl;
     std::cout << "Database path: " << database_path << std::endl;
     std::cout << "Table name: " << table_name << std::endl;
     std::cout << "Start date: " << start_date << std::endl;
     std::cout << "End date: " << end_date << std::endl;
     std::cout << "Output directory: " << output_dir << std::endl;
+    std::cout << "Instrument: " << instrument->symbol << " (tick size " << instrument->tickSize << ")" << std::endl;
     
     // Parse dates in format YYYY-MM-DD
     // Date struct defined in convertDatesToWeek.cpp
@@ -51,9 +95,36 @@ int main(int argc, char* argv[]) {
 
 //-----------------------------------------------------------------------------------------------------------------
     
+    // one tick source (connection + prepared statements) is shared by the whole run
+    std::unique_ptr<TickSource> tickSource;
+    const bool isParquet = std::filesystem::is_directory(database_path) ||
+                           std::filesystem::path(database_path).extension() == ".parquet";
+    if (std::filesystem::path(database_path).extension() == ".ticks") {
+        tickSource = openTickCacheSource(database_path, instrument->tickSize);
+    } else if (isParquet) {
+#ifdef FOOTPRINT_WITH_PARQUET
+        tickSource = openParquetTickSource(database_path, table_name, instrument->tickSize);
+#else
+        std::cerr << "Parquet input needs a build configured with -DFOOTPRINT_WITH_PARQUET=ON" << std::endl;
+        return 1;
+#endif
+    } else {
+        if (createIndex) {
+            std::cout << "Creating DateTime index on " << table_name << " (one time cost)..." << std::endl;
+            SqliteTickSource::createDateTimeIndex(database_path, table_name);
+        }
+        auto sqliteSource = std::make_unique<SqliteTickSource>(database_path, table_name, instrument->tickSize);
+        if (!sqliteSource->hasDateTimeIndex()) {
+            std::cout << "Warning: no DateTime index on " << table_name << ", every day will scan the whole table. "
+                      << "Rerun with --create-index to build it once." << std::endl;
+        }
+        tickSource = std::move(sqliteSource);
+    }
+
     // initialize the contract and signal datastructure
     Contract contract;
-    initializeContract(contract, database_path, table_name, startDate);
+    contract.instrument = *instrument;
+    initializeContract(contract, *tickSource, startDate);
     contract.contractName = table_name;
     std::cout << "Initialized contract for: " << contract.contractName << std::endl;
 
@@ -80,8 +151,12 @@ int main(int argc, char* argv[]) {
 //-----------------------------------------------------------------------------------------------------------------
 
     // call the finalProcessing function which accepts the contract by reference 
-    finalProcessing(bar_range,imbalanceThreshhold, contract, weeksVector, database_path,  table_name);
-//     and the weeksVector by reference and database path and table name and also signal structure by reference
+    if (streaming) {
+        finalProcessingStream(bar_range,imbalanceThreshhold, contract, weeksVector, *tickSource, lazyPriceFeatures);
+    } else {
+        finalProcessing(bar_range,imbalanceThreshhold, contract, weeksVector, *tickSource, lazyPriceFeatures);
+    }
+//     and the weeksVector by reference and the tick source and also signal structure by reference
     
     
     
@@ -0,0 +1,272 @@
+#ifndef ROLLING_WINDOW_H
+#define ROLLING_WINDOW_H
+
+#include <array>
+#include <vector>
+#include <cstddef>
+#include <stdexcept>
+#include <algorithm>
+
+
+// fixed window statistics for the indicators, the window is a compile time constant and every
+// accumulator keeps its own ring buffer, so an update is O(1) including the warm-up: while fewer than
+// N values were pushed the statistics are taken over the values seen so far.
+// N = RUNTIME_WINDOW sizes the ring at construction instead, for lookbacks chosen at runtime
+
+
+inline constexpr size_t RUNTIME_WINDOW = 0;
+
+
+// last N values in insertion order, at(0) is the oldest
+template <size_t N>
+class RingWindow {
+    static_assert(N > 0, "window must hold at least one value");
+public:
+    // stores x and returns the value it evicted (only meaningful when the window was full)
+    double push(double x) {
+        if (filled < N) {
+            values[(head + filled) % N] = x;
+            ++filled;
+            return 0.0;
+        }
+        const double oldest = values[head];
+        values[head] = x;
+        head = (head + 1) % N;
+        return oldest;
+    }
+
+    double at(size_t i) const { return values[(head + i) % N]; }
+    double back() const { return at(filled - 1); }
+    size_t size() const { return filled; }
+    bool full() const { return filled == N; }
+    static constexpr size_t capacity() { return N; }
+
+private:
+    std::array<double, N> values{};
+    size_t head = 0;
+    size_t filled = 0;
+};
+
+
+// the same ring with its capacity given at construction
+template <>
+class RingWindow<RUNTIME_WINDOW> {
+public:
+    explicit RingWindow(size_t capacity) : values(capacity) {
+        if (capacity == 0) {
+            throw std::invalid_argument("window must hold at least one value");
+        }
+    }
+
+    double push(double x) {
+        if (filled < values.size()) {
+            values[(head + filled) % values.size()] = x;
+            ++filled;
+            return 0.0;
+        }
+        const double oldest = values[head];
+        values[head] = x;
+        head = (head + 1) % values.size();
+        return oldest;
+    }
+
+    double at(size_t i) const { return values[(head + i) % values.size()]; }
+    double back() const { return at(filled - 1); }
+    size_t size() const { return filled; }
+    bool full() const { return filled == values.size(); }
+    size_t capacity() const { return values.size(); }
+
+private:
+    std::vector<double> values;
+    size_t head = 0;
+    size_t filled = 0;
+};
+
+
+// mean and population variance of the last N values, Welford's update with the evicted value removed
+template <size_t N>
+class RollingMeanVariance {
+public:
+    void push(double x) {
+        const bool wasFull = window.full();
+        const double oldest = window.push(x);
+        if (!wasFull) {
+            const double delta = x - m;
+            m += delta / window.size();
+            m2 += delta * (x - m);
+            return;
+        }
+        const double newMean = m + (x - oldest) / N;
+        m2 += (x - oldest) * ((x - newMean) + (oldest - m));
+        m = newMean;
+        if (m2 < 0.0) {
+            m2 = 0.0;   // rounding on a flat window
+        }
+    }
+
+    double mean() const { return m; }
+    double variance() const { return window.size() ? m2 / window.size() : 0.0; }
+    size_t count() const { return window.size(); }
+    bool full() const { return window.full(); }
+
+private:
+    RingWindow<N> window;
+    double m = 0.0;
+    double m2 = 0.0;   // sum of squared deviations from the mean
+};
+
+
+// minimum and maximum of the last N values, monotonic deques over the positions of the window
+template <size_t N>
+class RollingMinMax {
+public:
+    void push(double x) {
+        const size_t pos = pushed++;
+        if (pos >= N) {
+            // the value at pos - N leaves the window
+            if (minQueue.frontPos() == pos - N) minQueue.popFront();
+            if (maxQueue.frontPos() == pos - N) maxQueue.popFront();
+        }
+        while (!minQueue.empty() && minQueue.backValue() >= x) minQueue.popBack();
+        while (!maxQueue.empty() && maxQueue.backValue() <= x) maxQueue.popBack();
+        minQueue.pushBack(pos, x);
+        maxQueue.pushBack(pos, x);
+    }
+
+    double min() const { return minQueue.frontValue(); }   // only valid after a push
+    double max() const { return maxQueue.frontValue(); }
+    size_t count() const { return std::min(pushed, N); }
+    bool full() const { return pushed >= N; }
+
+private:
+    // deque of (position, value) that never holds more than N entries
+    class BoundedDeque {
+    public:
+        bool empty() const { return length == 0; }
+        size_t frontPos() const { return positions[first]; }
+        double frontValue() const { return values[first]; }
+        double backValue() const { return values[(first + length - 1) % N]; }
+        void popFront() { first = (first + 1) % N; --length; }
+        void popBack() { --length; }
+        void pushBack(size_t pos, double x) {
+            const size_t slot = (first + length) % N;
+            positions[slot] = pos;
+            values[slot] = x;
+            ++length;
+        }
+
+    private:
+        std::array<size_t, N> positions{};
+        std::array<double, N> values{};
+        size_t first = 0;
+        size_t length = 0;
+    };
+
+    BoundedDeque minQueue;
+    BoundedDeque maxQueue;
+    size_t pushed = 0;
+};
+
+
+// least squares line through the last N values at x = 0 (oldest) .. count - 1 (newest)
+// slope m = (n*Σ(xy) - Σx*Σy) / (n*Σ(x^2) - (Σx)^2)
+// the sums are exact for integer series (ticks, cumulative deltas) of any realistic size
+template <size_t N>
+class RollingLinearRegression {
+public:
+    RollingLinearRegression() = default;
+    explicit RollingLinearRegression(size_t capacity) : window(capacity) {}   // N = RUNTIME_WINDOW
+
+    void push(double y) {
+        const bool wasFull = window.full();
+        const double oldest = window.push(y);
+        if (!wasFull) {
+            sumXY += (window.size() - 1) * y;
+            sumY += y;
+            return;
+        }
+        // every value moves one x down, the oldest leaves and the new one comes in at x = capacity - 1
+        sumXY -= sumY - oldest;
+        sumY -= oldest;
+        sumXY += (window.capacity() - 1) * y;
+        sumY += y;
+    }
+
+    // 0 with fewer than two values
+    double slope() const {
+        return slopeOf(static_cast<double>(window.size()), sumY, sumXY);
+    }
+
+    // slope of the window followed by one more point `live` at x = count(), without pushing it
+    double slopeWith(double live) const {
+        const double n = static_cast<double>(window.size()) + 1;
+        return slopeOf(n, sumY + live, sumXY + (n - 1) * live);
+    }
+
+    double mean() const { return window.size() ? sumY / window.size() : 0.0; }
+    size_t count() const { return window.size(); }
+    size_t capacity() const { return window.capacity(); }
+    bool full() const { return window.full(); }
+
+private:
+    static double slopeOf(double n, double sY, double sXY) {
+        if (n < 2) {
+            return 0.0;
+        }
+        const double sumX = n * (n - 1) / 2.0;
+        const double denominator = n * n * (n * n - 1) / 12.0;
+        return (n * sXY - sumX * sY) / denominator;
+    }
+
+    RingWindow<N> window;
+    double sumY = 0.0;
+    double sumXY = 0.0;
+};
+
+
+// exponential smoothing avg = (avg * (N - 1) + x) / N, i.e. alpha = 1 / N.
+// the average is (re)seeded with x whenever it is 0, so a run of zero values at the start does not
+// drag the first non-zero value towards 0
+template <size_t N>
+class SmoothedAverage {
+public:
+    void push(double x) {
+        avg = avg == 0.0 ? x : (avg * (N - 1) + x) / N;
+        ++pushed;
+    }
+
+    double value() const { return avg; }
+    size_t count() const { return pushed; }
+
+private:
+    double avg = 0.0;
+    size_t pushed = 0;
+};
+
+
+// Wilder's smoothing: the plain mean of the values while fewer than N were pushed,
+// then avg = (avg * (N - 1) + x) / N
+template <size_t N>
+class WilderAverage {
+public:
+    void push(double x) {
+        if (pushed < N) {
+            sum += x;
+            ++pushed;
+            avg = sum / pushed;
+            return;
+        }
+        avg = ((avg * (N - 1)) + x) / N;
+    }
+
+    double value() const { return avg; }
+    size_t count() const { return pushed; }
+    bool seeded() const { return pushed >= N; }
+
+private:
+    double avg = 0.0;
+    double sum = 0.0;
+    size_t pushed = 0;
+};
+
+#endif // ROLLING_WINDOW_H
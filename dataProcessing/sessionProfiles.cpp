@@ -0,0 +1,110 @@
+#include <algorithm>
+
+#include "sessionProfiles.h"
+
+
+// ticks added on each side when the ladder has to grow, a day rarely moves further
+static constexpr int32_t LADDER_HEADROOM = 256;
+
+
+void SessionProfileStore::cover(int32_t low, int32_t high) {
+    const int32_t lastTick = firstTick + static_cast<int32_t>(width) - 1;
+    if (width != 0 && low >= firstTick && high <= lastTick) {
+        return;
+    }
+
+    const int32_t newFirst = width == 0 ? low - LADDER_HEADROOM : std::min(firstTick, low - LADDER_HEADROOM);
+    const int32_t newLast = width == 0 ? high + LADDER_HEADROOM : std::max(lastTick, high + LADDER_HEADROOM);
+    const size_t newWidth = static_cast<size_t>(newLast - newFirst + 1);
+
+    // rows keep their cumulative volume, ticks outside the old ladder start at zero
+    std::vector<int64_t> grown((sessions + 1) * newWidth, 0);
+    const size_t offset = static_cast<size_t>(firstTick - newFirst);
+    for (size_t s = 0; s <= sessions && width != 0; ++s) {
+        std::copy(row(s), row(s) + width, grown.begin() + s * newWidth + offset);
+    }
+
+    prefix.swap(grown);
+    firstTick = newFirst;
+    width = newWidth;
+}
+
+
+size_t SessionProfileStore::addSession(const VolumeProfile& profile) {
+    if (!profile.empty()) {
+        int32_t low = 0;
+        int32_t high = 0;
+        bool first = true;
+        profile.forEachLevel([&](int32_t tick, int64_t) {
+            if (first) {
+                low = tick;
+                first = false;
+            }
+            high = tick;
+        });
+        cover(low, high);
+    }
+
+    // the new row starts as a copy of the last one and gets this session's volume on top
+    prefix.resize((sessions + 2) * width);
+    std::copy(row(sessions), row(sessions) + width, prefix.begin() + (sessions + 1) * width);
+    int64_t* next = prefix.data() + (sessions + 1) * width;
+    profile.forEachLevel([&](int32_t tick, int64_t volume) {
+        next[tick - firstTick] += volume;
+    });
+
+    return sessions++;
+}
+
+
+CompositeProfile SessionProfileStore::composite(size_t first, size_t last, double share) const {
+    CompositeProfile result;
+    last = std::min(last, sessions);
+    if (first >= last || width == 0) {
+        return result;
+    }
+
+    const int64_t* upper = row(last);
+    const int64_t* lower = row(first);
+
+    // one pass over the ladder: cumulative volume by price plus the POC and the high volume node,
+    // the lower price wins ties like in the session profiles
+    std::vector<int64_t> cumulative(width);
+    int64_t total = 0;
+    int64_t maxVolume = 0;
+    int64_t secondMaxVolume = 0;
+    size_t poc = 0;
+    size_t hvn = 0;
+    for (size_t i = 0; i < width; ++i) {
+        const int64_t volume = upper[i] - lower[i];
+        total += volume;
+        cumulative[i] = total;
+        if (volume > maxVolume) {
+            secondMaxVolume = maxVolume;
+            hvn = poc;
+            maxVolume = volume;
+            poc = i;
+        } else if (volume > secondMaxVolume) {
+            secondMaxVolume = volume;
+            hvn = i;
+        }
+    }
+    if (total == 0) {
+        return result;
+    }
+
+    // value area by volume quantiles: binary search for the prices where the cumulative volume
+    // passes the lower and the upper tail, (1 - share) / 2 of the volume is left out on each side
+    const double tail = total * (1.0 - share) / 2.0;
+    auto valIt = std::upper_bound(cumulative.begin(), cumulative.end(), tail,
+                                  [](double value, int64_t cum) { return value < static_cast<double>(cum); });
+    auto vahIt = std::lower_bound(cumulative.begin(), cumulative.end(), total - tail,
+                                  [](int64_t cum, double value) { return static_cast<double>(cum) < value; });
+
+    result.pocTicks = firstTick + static_cast<int32_t>(poc);
+    result.hvnTicks = secondMaxVolume > 0 ? firstTick + static_cast<int32_t>(hvn) : 0;
+    result.valTicks = firstTick + static_cast<int32_t>(valIt - cumulative.begin());
+    result.vahTicks = firstTick + static_cast<int32_t>(vahIt - cumulative.begin());
+    result.totalVolume = total;
+    return result;
+}
@@ -0,0 +1,54 @@
+#ifndef SESSION_PROFILES_H
+#define SESSION_PROFILES_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "volumeProfile.h"
+
+
+// profile levels of a composite of sessions, prices in ticks
+struct CompositeProfile {
+    int32_t pocTicks = 0;
+    int32_t vahTicks = 0;
+    int32_t valTicks = 0;
+    int32_t hvnTicks = 0;        // largest level besides the POC
+    int64_t totalVolume = 0;     // 0 marks an empty composite, the levels are 0 then
+};
+
+
+// volume histogram of every finished session (day) of the contract on one fixed tick ladder,
+// stored as prefix sums over the sessions: row s holds the volume per tick of sessions [0, s).
+// the volume of any run of sessions is then one row difference, so composite profiles
+// (last N sessions, contract to date, ...) cost O(ladder) and never touch bars.
+// the ladder covers every price seen so far with some headroom, a session outside of it
+// re-bases all rows once (rare, the contract's price range settles after a few sessions)
+class SessionProfileStore {
+public:
+    // appends a finished session, returns its index
+    size_t addSession(const VolumeProfile& profile);
+
+    size_t sessionCount() const { return sessions; }
+
+    // composite of the sessions [first, last), the value area holds `share` of the volume
+    CompositeProfile composite(size_t first, size_t last, double share = VALUE_AREA_SHARE) const;
+
+    // composite of the last n finished sessions (all of them if fewer exist)
+    CompositeProfile lastSessions(size_t n, double share = VALUE_AREA_SHARE) const {
+        return composite(sessions > n ? sessions - n : 0, sessions, share);
+    }
+
+private:
+    // grows the ladder to cover [low, high], the existing rows are copied onto the new ladder
+    void cover(int32_t low, int32_t high);
+
+    const int64_t* row(size_t s) const { return prefix.data() + s * width; }
+
+    int32_t firstTick = 0;
+    size_t width = 0;             // ticks in the ladder
+    size_t sessions = 0;
+    std::vector<int64_t> prefix;  // (sessions + 1) rows of width, row 0 is all zero
+};
+
+#endif // SESSION_PROFILES_H
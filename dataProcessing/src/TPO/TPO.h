@@ -1,12 +1,12 @@
 #ifndef TPO_H
 #define TPO_H
 
-#include "dataStructure.h"
+#include "engineContext.h"
 
 
-void calculateDayTPO(Contract& contract);
+void calculateDayTPO(EngineContext& ctx);
 
-void calculateWeekTPO(Contract& contract);
+void calculateWeekTPO(EngineContext& ctx);
 
 
 
@@ -1,9 +1,9 @@
-#include "../dataStructure.h"
+#include "../engineContext.h"
 
 
 
-void finalizeProcessingDay(Contract& contract) {
-    auto& DAY = contract.weeks.back().days.back();
+void finalizeProcessingDay(EngineContext& ctx) {
+    auto& DAY = *ctx.day;
 
     
     // here those calculation will be done which are nessesary only at the end of the day like end time
@@ -3,18 +3,25 @@
 #include <cmath>     // For std::pow and std::sqrt
 #include <iomanip>   // For std::setprecision
 
-#include "dataStructure.h"
+#include "engineContext.h"
 
-void calculateBBands(Contract& contract) {
+void calculateBBands(EngineContext& ctx) {
     // --- Constants ---
     // We use a 21-period lookback
     const int WILDER_PERIOD = 21;
     const double K_MULTIPLIER = 2.4;
 
-    auto& day = contract.weeks.back().days.back();
-    int n = day.bars.size();
+    auto& day = *ctx.day;
+    const auto& SPEC = ctx.contract.instrument;
+    const auto& closes = day.closedBars.closeTicks;
+    int n = closes.size();
     
 
+    // the first 21 closes are the seed, the window adds them as they close
+    if (n >= 1 && n <= WILDER_PERIOD) {
+        day.bbSeedCloses.push(SPEC.toPrice(closes.back()));
+    }
+
     // Do nothing if the vector is empty
     if (n < 2) {
         return;
@@ -23,22 +30,11 @@ void calculateBBands(Contract& contract) {
     // --- Rule 2: Seeding Phase (2 <= n <= 21) ---
     // We use a simple moving average (SMA) and population variance
     // as the seed for the Wilder's smoothing.
-    // This is an O(n) calculation, which is necessary for seeding.
+    // The window holds every close so far, so the seed is O(1) per bar.
     if (n <= WILDER_PERIOD && n >= 2) {
 
-        // Calculate SMA
-        double sum_prices = 0.0;
-        for (int i = 0; i < n; ++i) {
-            sum_prices += day.bars[i].close;
-        }
-        day.bbMiddle = sum_prices / n;
-
-        // Calculate Population Variance
-        double sum_sq_diff = 0.0;
-        for (int i = 0; i < n; ++i) {
-            sum_sq_diff += std::pow(day.bars[i].close - day.bbMiddle, 2);
-        }
-        day.variance = sum_sq_diff / n;
+        day.bbMiddle = day.bbSeedCloses.mean();
+        day.variance = day.bbSeedCloses.variance();
 
         // 3. Calculate new Upper and Lower Bands
         double std_dev = std::sqrt(day.variance);
@@ -55,12 +51,12 @@ void calculateBBands(Contract& contract) {
 
         // 1. Calculate new Middle Band (Wilder's Smoothing)
         //    Formula: WS_t = WS_{t-1} + alpha * (P_new - WS_{t-1})
-        day.bbMiddle = day.bbMiddle + alpha * (day.bars.back().close - day.bbMiddle);
+        day.bbMiddle = day.bbMiddle + alpha * (SPEC.toPrice(closes.back()) - day.bbMiddle);
 
         // 2. Calculate new Exponential Variance
         //    Formula: Var_t = (1-alpha) * Var_{t-1} + alpha * (P_new - WS_t)^2
         //    We use the *new* middle band for the squared difference.
-        double sq_diff = std::pow(day.bars.back().close - day.bbMiddle, 2);
+        double sq_diff = std::pow(SPEC.toPrice(closes.back()) - day.bbMiddle, 2);
         day.variance = (1.0 - alpha) * day.variance + alpha * sq_diff;
 
         // 3. Calculate new Upper and Lower Bands
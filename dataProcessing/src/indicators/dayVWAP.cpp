@@ -3,12 +3,13 @@
 #include <string>
 #include <cmath>     // For std::sqrt
 #include <iomanip>   // For std::setprecision
-#include "dataStructure.h"
+#include "engineContext.h"
 
 
-void calculateDayVWAP(Contract& contract) {
-    auto& DAY = contract.weeks.back().days.back();
+void calculateDayVWAP(EngineContext& ctx) {
+    auto& DAY = *ctx.day;
     auto& lastBAR = DAY.bars.back();
+    const auto& SPEC = ctx.contract.instrument;
      
 
     // --- VWAP & Std Dev Calculation ---
@@ -16,7 +17,7 @@ void calculateDayVWAP(Contract& contract) {
     if (lastBAR.barTotalVolume > 0) {
 
         // 1. Calculate new bar's values
-        double typicalPrice = (lastBAR.high + lastBAR.low + lastBAR.close) / 3.0;
+        double typicalPrice = (SPEC.toPrice(lastBAR.highTicks) + SPEC.toPrice(lastBAR.lowTicks) + SPEC.toPrice(lastBAR.closeTicks)) / 3.0;
         double priceVolume = typicalPrice * lastBAR.barTotalVolume;
         
         // 2. Update cumulative state
@@ -1,38 +1,61 @@
 #include <cmath>
 #include <numeric>
+#include <algorithm>
 #include "indicators.h"
-#include "../../dataStructure.h"
+#include "../../engineContext.h"
 
-double calculatePriceCumDeltaDivergence(Contract& contract, int lookbackBars) {
-    auto& day = contract.weeks.back().days.back();
-    auto& bars = day.bars;
-    int n = bars.size();
-    if (n < lookbackBars) return 0.0;
 
-    // 1. Calculate typical Volume Intensity (O(1) update suggested elsewhere, 
-    // but here is the logic for the scaler)
+// rolling state of a lookback, created on first use and seeded once from the closed bar columns,
+// from then on updatePriceCumDeltaDivergenceState moves it bar by bar
+static DivergenceWindow& divergenceWindow(Day& day, int lookbackBars) {
+    for (auto& window : day.divergenceWindows) {
+        if (window.lookbackBars == lookbackBars) {
+            return window;
+        }
+    }
+    DivergenceWindow& window = day.divergenceWindows.emplace_back(lookbackBars);
+    const auto& closed = day.closedBars;
+    const size_t seed = std::min(closed.size(), window.price.capacity());
+    for (size_t idx = closed.size() - seed; idx < closed.size(); ++idx) {
+        window.price.push(closed.closeTicks[idx]);
+        window.cumDelta.push(closed.cumDeltaAtBar[idx]);
+    }
+    return window;
+}
+
+
+void updatePriceCumDeltaDivergenceState(EngineContext& ctx) {
+    auto& day = *ctx.day;
+    const auto& closed = day.closedBars;
+    if (closed.size() == 0) return;
+
+    for (auto& window : day.divergenceWindows) {
+        window.price.push(closed.closeTicks.back());
+        window.cumDelta.push(closed.cumDeltaAtBar.back());
+    }
+
+    // 1. Calculate typical Volume Intensity of the closed bars
     // We use absolute delta to understand the 'force' regardless of direction.
-    double currentAbsDelta = std::abs(static_cast<double>(bars.back().delta));
-    
+    double closedAbsDelta = std::abs(static_cast<double>(closed.delta.back()));
+
     // Simple EMA to smooth the volume scaler
-    if (day.avgAbsDelta10 == 0.0) day.avgAbsDelta10 = currentAbsDelta;
-    else day.avgAbsDelta10 = (day.avgAbsDelta10 * 9.0 + currentAbsDelta) / 10.0;
-
-    // 2. Linear Regression Slopes (Same as your previous code)
-    double sumY_p = 0, sumXY_p = 0, sumY_c = 0, sumXY_c = 0;
-    for (int i = 0; i < lookbackBars; ++i) {
-        int idx = n - lookbackBars + i;
-        sumY_p += bars[idx].close;
-        sumXY_p += (i * bars[idx].close);
-        sumY_c += bars[idx].cumDeltaAtBar;
-        sumXY_c += (i * bars[idx].cumDeltaAtBar);
-    }
+    day.avgAbsDelta10.push(closedAbsDelta);
+}
+
+
+double calculatePriceCumDeltaDivergence(EngineContext& ctx, int lookbackBars) {
+    if (lookbackBars < 2) return 0.0;
+    auto& day = *ctx.day;
+    const Bar& liveBar = *ctx.bar;
+    const auto& SPEC = ctx.contract.instrument;
 
-    double denominator = (lookbackBars == 5) ? 50.0 : 330.0;
-    double sumX = (lookbackBars == 5) ? 10.0 : 45.0;
+    // the window is the last lookbackBars - 1 closed bars followed by the live bar
+    const DivergenceWindow& window = divergenceWindow(day, lookbackBars);
+    if (!window.price.full()) return 0.0;
 
-    double pSlope = (lookbackBars * sumXY_p - sumX * sumY_p) / denominator;
-    double cSlope = (lookbackBars * sumXY_c - sumX * sumY_c) / denominator;
+    // 2. Linear Regression Slopes, O(1) from the rolling sums
+    double pSlope = window.price.slopeWith(liveBar.closeTicks) * SPEC.tickSize;
+    double cSlope = window.cumDelta.slopeWith(liveBar.cumDeltaAtBar);
 
     // 3. APPLY DYNAMIC SCALES
     // Price Scale: Based on your 2.5 range bar
@@ -40,7 +63,7 @@ double calculatePriceCumDeltaDivergence(Contract& contract, int lookbackBars) {
 
     // CVD Scale: Normalized by the current volume regime
     // If avgAbsDelta10 is 0 (no volume), we avoid division by zero.
-    double cvdScale = (day.avgAbsDelta10 > 0) ? (1.0 / day.avgAbsDelta10) : 0.001;
+    double cvdScale = (day.avgAbsDelta10.value() > 0) ? (1.0 / day.avgAbsDelta10.value()) : 0.001;
 
     // 4. Convert to Angles
     double pAngle = std::atan(pSlope * priceScale) * (180.0 / M_PI);
@@ -51,4 +74,4 @@ double calculatePriceCumDeltaDivergence(Contract& contract, int lookbackBars) {
     // Bullish: cAngle is high (positive), pAngle is low (negative) -> Large Positive Result
     // Bearish: cAngle is low (negative), pAngle is high (positive) -> Large Negative Result
     return cAngle - pAngle;
-}
\ No newline at end of file
+}
@@ -1,62 +1,32 @@
 #include "indicators.h"
-#include "../../dataStructure.h"
+#include "../../engineContext.h"
 #include <cmath>
-#include <vector>
-#include <numeric>
 
-void calculateDeltaZscore(Contract& contract) {
-    auto& day = contract.weeks.back().days.back();
-    int n = day.bars.size();
+// z-score of the closed bar's delta against the last 11 closed bars (the bar itself included),
+// the window keeps mean and variance in O(1), over the bars seen so far during the first 11
+void calculateDeltaZscore(EngineContext& ctx) {
+    auto& day = *ctx.day;
+    const auto& deltas = day.closedBars.delta;
 
-    if (n == 0) {
+    if (deltas.empty()) {
         return;
     }
 
-    double newDelta = static_cast<double>(day.bars.back().delta);
+    double newDelta = static_cast<double>(deltas.back());
+    day.deltaWindow.push(newDelta);
 
-    if (n == 1) {
+    if (day.deltaWindow.count() == 1) {
         day.deltaZscore11bars = newDelta;
-        day.deltaSum = newDelta;
-        day.deltaSumOfSquares = newDelta * newDelta;
         return;
     }
 
-    if (n <= 11) {
-        // O(N) calculation for the first 12 bars
-        std::vector<double> deltas;
-        for (const auto& bar : day.bars) {
-            deltas.push_back(static_cast<double>(bar.delta));
-        }
+    double mean = day.deltaWindow.mean();
+    double variance = day.deltaWindow.variance();
+    double stdDev = (variance > 0) ? std::sqrt(variance) : 0;
 
-        day.deltaSum = std::accumulate(deltas.begin(), deltas.end(), 0.0);
-        day.deltaSumOfSquares = 0.0;
-        for(double d : deltas) {
-            day.deltaSumOfSquares += d * d;
-        }
-
-        double mean = day.deltaSum / n;
-        double variance = (day.deltaSumOfSquares / n) - (mean * mean);
-        double stdDev = (variance > 0) ? std::sqrt(variance) : 0;
-
-        if (stdDev != 0) {
-            day.deltaZscore11bars = (newDelta - mean) / stdDev;
-        } else {
-            day.deltaZscore11bars = 0;
-        }
-    } else { // n > 11
-        // O(1) rolling calculation
-        double oldDelta = static_cast<double>(day.bars[n - 12].delta);
-        day.deltaSum += newDelta - oldDelta;
-        day.deltaSumOfSquares += newDelta * newDelta - oldDelta * oldDelta;
-
-        double mean = day.deltaSum / 11;
-        double variance = (day.deltaSumOfSquares / 11) - (mean * mean);
-        double stdDev = (variance > 0) ? std::sqrt(variance) : 0;
-
-        if (stdDev != 0) {
-            day.deltaZscore11bars = (newDelta - mean) / stdDev;
-        } else {
-            day.deltaZscore11bars = 0;
-        }
+    if (stdDev != 0) {
+        day.deltaZscore11bars = (newDelta - mean) / stdDev;
+    } else {
+        day.deltaZscore11bars = 0;
     }
-}
\ No newline at end of file
+}
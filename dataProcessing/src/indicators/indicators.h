@@ -1,7 +1,7 @@
 #ifndef INDICATORS_H
 #define INDICATORS_H
 
-#include "dataStructure.h"
+#include "engineContext.h"
 
 #include <string>
 #include <utility>
@@ -13,27 +13,29 @@
 // rsi calculations
     // this will create a single columnin the day struct in the days vector of week struct
     // this will add only one result in the day.RSI
-void calculateRSI(Contract& contract);
+void calculateRSI(EngineContext& ctx);
 
 // bollinger band
-void calculateBBands(Contract& contract);
+void calculateBBands(EngineContext& ctx);
 
 
 // vwap calculations
-void calculateDayVWAP(Contract& contract);
-void calculateWeekVWAP(Contract& contract);
+void calculateDayVWAP(EngineContext& ctx);
+void calculateWeekVWAP(EngineContext& ctx);
 
 // deltaZscore for 20 bar
-void calculateDeltaZscore(Contract& contract);
+void calculateDeltaZscore(EngineContext& ctx);
 
 // cumulative delta slope
-void calculateCumDelta5barsSlope(Contract& contract);
+void calculateCumDelta5barsSlope(EngineContext& ctx);
 
-// price cumulative delta divergence
-double calculatePriceCumDeltaDivergence(Contract& contract, int lookbackBars);
+// price cumulative delta divergence, any lookback of at least 2 bars (the last one is the live bar)
+double calculatePriceCumDeltaDivergence(EngineContext& ctx, int lookbackBars);
+// moves the divergence state to the bar just closed, called once per bar
+void updatePriceCumDeltaDivergenceState(EngineContext& ctx);
 
 // interaction reversal
-void calculateInteractionReversal(Contract& contract);
+void calculateInteractionReversal(EngineContext& ctx);
 
 
 
@@ -1,18 +1,18 @@
 #include <cmath>
 #include <numeric>
 #include "indicators.h"
-#include "../../dataStructure.h"
+#include "../../engineContext.h"
 
 
-void calculateInteractionReversal(Contract& contract) {
-    auto& day = contract.weeks.back().days.back();
+void calculateInteractionReversal(EngineContext& ctx) {
+    auto& day = *ctx.day;
     if (day.bars.empty()) return;
 
     auto& currentBar = day.bars.back();
 
     // 1. Calculate the raw distance from VWAP
     // We use the 'close' price of the bar
-    double vwapDist = currentBar.close - day.vwap;
+    double vwapDist = ctx.contract.instrument.toPrice(currentBar.closeTicks) - day.vwap;
 
     // 2. Interaction Reversal Calculation
     // We use your 11-bar Z-score
@@ -3,11 +3,11 @@
 #include <string>
 #include <cmath>     // For std::sqrt
 #include <iomanip>   // For std::setprecision
-#include "dataStructure.h"
+#include "engineContext.h"
 
 
-void calculateWeekVWAP(Contract& contract) {
-    auto& WEEK = contract.weeks.back();
+void calculateWeekVWAP(EngineContext& ctx) {
+    auto& WEEK = *ctx.week;
     auto& day = WEEK.days.back(); // Reference the current day
     
     // Get the current bar (the one just processed)
@@ -24,7 +24,7 @@ void calculateWeekVWAP(Contract& contract) {
         // VWAP typically uses (high + low + close) / 3 or (open + high + low + close) / 4
         // For simplicity and consistency, let's use the bar's close price as the typical price
         // or (currentBar.high + currentBar.low + currentBar.close) / 3.0; if preferred
-        double typicalPrice = currentBar.close; 
+        double typicalPrice = ctx.contract.instrument.toPrice(currentBar.closeTicks); 
         double priceVolume = typicalPrice * currentBar.barTotalVolume; // Use currentBar.volume
         
         // 2. Update cumulative state
@@ -1,11 +1,11 @@
-#include "../dataStructure.h"
+#include "../engineContext.h"
 
 // this function will do the following
     // first of all add new bar in the bars vector of the current day
         // initialize all the features of the new bar
 
-void initializeNewBar(Contract& contract, std::string currentTime, double currentPrice, int currentAskVolume, int currentBidVolume) {
-    auto& DAY = contract.weeks.back().days.back();
+void initializeNewBar(EngineContext& ctx, int64_t currentTime, int32_t currentTicks, int currentAskVolume, int currentBidVolume) {
+    auto& DAY = *ctx.day;
 
     // UPDATE THE END TIME OF THE LAST BAR
     DAY.bars.back().endTime = currentTime;
@@ -14,34 +14,32 @@ void initializeNewBar(Contract& contract, std::string currentTime, double curren
     //but first initializing values
     Bar newBar;
     newBar.startTime = currentTime;
-    newBar.open = currentPrice;
-    newBar.high = currentPrice;
-    newBar.low = currentPrice;
-    newBar.close = currentPrice;
+    newBar.openTicks = currentTicks;
+    newBar.highTicks = currentTicks;
+    newBar.lowTicks = currentTicks;
+    newBar.closeTicks = currentTicks;
     newBar.barTotalVolume = currentAskVolume + currentBidVolume;
     newBar.startTime = currentTime;
-    newBar.endTime = "-1";
+    newBar.endTime = NO_TIME;
     newBar.barDeltaChange = 0;
     newBar.barHighDelta = 0;
     newBar.barLowDelta = 0;
     newBar.signal = 0;
     newBar.signalID = -1;
     newBar.signalStatus = false;
-    newBar.priceBBandLowerDiff = 0.0;
-    newBar.priceBBandUpperDiff = 0.0;
-
-    PriceLevel newPriceLevel;
-    Footprint& newFootprint = newBar.footprint;
-    newPriceLevel.bidVolume = currentBidVolume;
-    newPriceLevel.askVolume = currentAskVolume;
-    newPriceLevel.isBuyImbalance = false;
-    newPriceLevel.isSellImbalance = false;
-    newFootprint.priceLevels[currentPrice] = newPriceLevel;
-
-    //addding new bar
-    
+
+    //addding new bar, with an empty feature block next to it
     DAY.bars.push_back(newBar);
-    DAY.bars.back().footprint.priceLevels[currentPrice] = newPriceLevel;
+    DAY.barFeatures.emplace_back();
+    ctx.refreshBar();
+
+    // opening tick of the bar, updateFootprint then adds it to the level like every other tick
+    PriceLevel& firstLevel = ctx.bar->footprint.priceLevels.trade(currentTicks);
+    firstLevel.bidVolume = currentBidVolume;
+    firstLevel.askVolume = currentAskVolume;
+    // the session profiles mirror the level volume, opening tick included
+    DAY.profile.add(currentTicks, currentBidVolume + currentAskVolume, currentAskVolume - currentBidVolume);
+    ctx.week->profile.add(currentTicks, currentBidVolume + currentAskVolume, currentAskVolume - currentBidVolume);
 
 
 }
\ No newline at end of file
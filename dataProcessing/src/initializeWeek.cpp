@@ -1,12 +1,13 @@
-#include "../dataStructure.h"
+#include "../engineContext.h"
 
 
 
 
-void initializeWeek(Contract& contract) {
+void initializeWeek(EngineContext& ctx) {
     Week newWeek;
 
-    contract.weeks.push_back(newWeek);
+    ctx.contract.weeks.push_back(newWeek);
+    ctx.refresh();
     
     
 }
\ No newline at end of file
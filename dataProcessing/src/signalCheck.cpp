@@ -1,9 +1,14 @@
-#include "../dataStructure.h"
+#include "../engineContext.h"
+#include "updatefeatures.h"
 
 
 
-void checkForSignal(Contract& contract){
-    auto& BAR = contract.weeks.back().days.back().bars.back();
+void checkForSignal(EngineContext& ctx){
+    auto& BAR = *ctx.bar;
+    // a new signal is taken with the bar's price features, in lazy mode they are derived now
+    if (!BAR.signalStatus) {
+        materializePriceFeatures(ctx);
+    }
     // this is the demo logic for signal checking
     BAR.signal = 1;
     BAR.signalID = 1;
@@ -1,6 +1,7 @@
-#include "../dataStructure.h"
+#include "../engineContext.h"
 #include "../src/indicators/indicators.h"
 #include "../src/TPO/TPO.h"
+#include "updatefeatures.h"
 
 
 // this function called at the last tick of the bar to calculate the bar change features
@@ -16,34 +17,44 @@
         // close
 
 
-void updateBarChangeSensitiveFeatures(Contract& contract, double currentPrice, int currentAskVolume, int currentBidVolume) {
+void updateBarChangeSensitiveFeatures(EngineContext& ctx, int32_t currentTicks, int currentAskVolume, int currentBidVolume) {
     // Update bar change sensitive features
-    auto& WEEK = contract.weeks.back();
-    auto& Day = contract.weeks.back().days.back();
+    auto& WEEK = *ctx.week;
+    auto& Day = *ctx.day;
     auto& Bar = Day.bars.back();
+
+    // lazy price features are derived before the levels they are measured against move
+    materializePriceFeatures(ctx);
+
+    // the bar is complete, the indicator kernels below read the day's history from the columns
+    Day.closedBars.append(Bar);
+    updatePriceCumDeltaDivergenceState(ctx);
     
     // updating the day basics
-    Day.dayHigh = std::max(Day.dayHigh, Bar.high);
-    Day.dayLow = std::min(Day.dayLow, Bar.low);
-    Day.dayClose = currentPrice;
+    Day.dayHighTicks = std::max(Day.dayHighTicks, Bar.highTicks);
+    Day.dayLowTicks = std::min(Day.dayLowTicks, Bar.lowTicks);
+    Day.dayCloseTicks = currentTicks;
 
     // week basic
-    WEEK.weekHigh = std::max(WEEK.weekHigh, Day.dayHigh);
+    WEEK.weekHighTicks = std::max(WEEK.weekHighTicks, Day.dayHighTicks);
     
-    WEEK.weekLow = std::min(WEEK.weekLow, Day.dayLow);
+    WEEK.weekLowTicks = std::min(WEEK.weekLowTicks, Day.dayLowTicks);
 
 
     
 
     // calculating the indicators 
-    calculateDayVWAP(contract);
-    calculateWeekVWAP(contract);
-    calculateBBands(contract);
-    calculateRSI(contract);
-    calculateDayTPO(contract);
-    calculateWeekTPO(contract);
-    calculateDeltaZscore(contract);
-    calculateCumDelta5barsSlope(contract);
+    calculateDayVWAP(ctx);
+    calculateWeekVWAP(ctx);
+    calculateBBands(ctx);
+    calculateRSI(ctx);
+    calculateDayTPO(ctx);
+    calculateWeekTPO(ctx);
+    calculateDeltaZscore(ctx);
+    calculateCumDelta5barsSlope(ctx);
+
+    // the levels of the next bar's price features
+    snapshotPriceReferences(ctx);
     
 
 
@@ -1,10 +1,20 @@
-#include "../dataStructure.h"
+#include "../engineContext.h"
+#include "updatefeatures.h"
 
 
 
-void updateDayChangeSensitiveFeatures(Contract& contract) {
+void updateDayChangeSensitiveFeatures(EngineContext& ctx) {
     // Update day change sensitive features
-    auto& DAY = contract.weeks.back().days.back();
+    auto& DAY = *ctx.day;
+
+    // the last bar of the day has no bar close
+    materializePriceFeatures(ctx);
+
+    // the live bar is never closed by a range break on the last tick of the day, it completes the columns here
+    DAY.closedBars.append(DAY.bars.back());
+
+    // the finished day becomes one session of the composite profiles
+    ctx.contract.sessionProfiles.addSession(DAY.profile);
 
     
     
@@ -1,28 +1,19 @@
-#include "../dataStructure.h"
+#include "../engineContext.h"
 
 
 
-std::pair<int, int> updateFootprint(Contract& contract, double imbalanceThreshhold, double price, int bidVolume, int askVolume) {
-    // if price level exists, update volumes
-    auto& FOOTPRINT = contract.weeks.back().days.back().bars.back().footprint;
-    if (FOOTPRINT.priceLevels.find(price) != FOOTPRINT.priceLevels.end()){
-        FOOTPRINT.priceLevels[price].bidVolume += bidVolume;
-        FOOTPRINT.priceLevels[price].askVolume += askVolume;
-        FOOTPRINT.priceLevels[price].volumeAtPrice += (bidVolume + askVolume);
-        FOOTPRINT.priceLevels[price].deltaAtPrice += (askVolume - bidVolume);
-        
-    }
-    else{
-    // else create new price level and set volumes
-    PriceLevel newLevel;
-    newLevel.bidVolume = bidVolume;
-    newLevel.askVolume = askVolume;
-    newLevel.isBuyImbalance = false;
-    newLevel.isSellImbalance = false;
-    newLevel.volumeAtPrice = (bidVolume + askVolume);
-    newLevel.deltaAtPrice = (askVolume - bidVolume);
-    FOOTPRINT.priceLevels[price] = newLevel;
-    }
+std::pair<int, int> updateFootprint(EngineContext& ctx, double imbalanceThreshhold, int32_t tick, int bidVolume, int askVolume) {
+    // add the tick to its price level, a new price extends the ladder
+    auto& FOOTPRINT = ctx.bar->footprint;
+    PriceLevel& current = FOOTPRINT.priceLevels.trade(tick);
+    current.bidVolume += bidVolume;
+    current.askVolume += askVolume;
+    current.volumeAtPrice += (bidVolume + askVolume);
+    current.deltaAtPrice += (askVolume - bidVolume);
+
+    // the session profiles take the same volume as the footprint level
+    ctx.day->profile.add(tick, bidVolume + askVolume, askVolume - bidVolume);
+    ctx.week->profile.add(tick, bidVolume + askVolume, askVolume - bidVolume);
     
 
 
@@ -59,70 +50,75 @@ std::pair<int, int> updateFootprint(Contract& contract, double imbalanceThreshho
     //calculate imbalance
     // --- New Imbalance Calculation Logic ---
     if (FOOTPRINT.priceLevels.size() >= 2) {
-        // Use safe iterators to determine if the current price is at the top or bottom
-        bool isLowestPrice = (FOOTPRINT.priceLevels.begin()->first == price);
-        bool isHighestPrice = (FOOTPRINT.priceLevels.rbegin()->first == price);
+        // the ends of the ladder are always traded prices
+        bool isLowestPrice = (FOOTPRINT.priceLevels.lowTick() == tick);
+        bool isHighestPrice = (FOOTPRINT.priceLevels.highTick() == tick);
 
+        // neighbours are inside the ladder, a price nobody traded at counts as an empty level
         // Case 1: Current price is the LOWEST in the footprint
         if (isLowestPrice) {
-            // A) Calculate SELL imbalance at the current price (price)
+            PriceLevel& above = FOOTPRINT.priceLevels.at(tick + 1);
+            // A) Calculate SELL imbalance at the current price
             sell_imb_change += check_and_update(
-            FOOTPRINT.priceLevels[price].isSellImbalance, // imbalance flag
-            FOOTPRINT.priceLevels[price].bidVolume, // aggressor
-            FOOTPRINT.priceLevels[price + 0.25].askVolume,
+            current.isSellImbalance, // imbalance flag
+            current.bidVolume, // aggressor
+            above.askVolume,
             imbalanceThreshhold );
 
-            // B) Calculate BUY imbalance at the next price level (price + 0.25)
+            // B) Calculate BUY imbalance at the next price level (one tick above)
             buy_imb_change += check_and_update(
-            FOOTPRINT.priceLevels[price+0.25].isBuyImbalance, // imbalance flag
-            FOOTPRINT.priceLevels[price+0.25].askVolume, // The value that just changed
-            FOOTPRINT.priceLevels[price].bidVolume,
+            above.isBuyImbalance, // imbalance flag
+            above.askVolume, // The value that just changed
+            current.bidVolume,
             imbalanceThreshhold );
         }
         // Case 2: Current price is the HIGHEST in the footprint
         else if (isHighestPrice) {
-            // A) Calculate BUY imbalance at the current price (price)
+            PriceLevel& below = FOOTPRINT.priceLevels.at(tick - 1);
+            // A) Calculate BUY imbalance at the current price
             buy_imb_change += check_and_update(
-            FOOTPRINT.priceLevels[price].isBuyImbalance, // imbalance flag
-            FOOTPRINT.priceLevels[price].askVolume, // aggressor
-            FOOTPRINT.priceLevels[price-0.25].bidVolume,
+            current.isBuyImbalance, // imbalance flag
+            current.askVolume, // aggressor
+            below.bidVolume,
             imbalanceThreshhold );
 
-            // B) Calculate SELL imbalance at the previous price level (price - 0.25)
+            // B) Calculate SELL imbalance at the previous price level (one tick below)
             sell_imb_change += check_and_update(
-            FOOTPRINT.priceLevels[price-0.25].isSellImbalance, // imbalance flag
-            FOOTPRINT.priceLevels[price-0.25].bidVolume, // aggressor
-            FOOTPRINT.priceLevels[price].askVolume,
+            below.isSellImbalance, // imbalance flag
+            below.bidVolume, // aggressor
+            current.askVolume,
             imbalanceThreshhold );
         }
         // Case 3: Current price is in the MIDDLE of the footprint
         else {
-            // A) Calculate BUY imbalance at the current price (price)
+            PriceLevel& above = FOOTPRINT.priceLevels.at(tick + 1);
+            PriceLevel& below = FOOTPRINT.priceLevels.at(tick - 1);
+            // A) Calculate BUY imbalance at the current price
             buy_imb_change += check_and_update(
-            FOOTPRINT.priceLevels[price].isBuyImbalance, // imbalance flag
-            FOOTPRINT.priceLevels[price].askVolume, // aggressor
-            FOOTPRINT.priceLevels[price-0.25].bidVolume,
+            current.isBuyImbalance, // imbalance flag
+            current.askVolume, // aggressor
+            below.bidVolume,
             imbalanceThreshhold );
 
-            // B) Calculate SELL imbalance at the current price (price)
+            // B) Calculate SELL imbalance at the current price
             sell_imb_change += check_and_update(
-            FOOTPRINT.priceLevels[price].isSellImbalance, // imbalance flag
-            FOOTPRINT.priceLevels[price].bidVolume, // aggressor
-            FOOTPRINT.priceLevels[price + 0.25].askVolume,
+            current.isSellImbalance, // imbalance flag
+            current.bidVolume, // aggressor
+            above.askVolume,
             imbalanceThreshhold );
 
-            // C) Calculate BUY imbalance at the next price level (price + 0.25)
+            // C) Calculate BUY imbalance at the next price level (one tick above)
             buy_imb_change += check_and_update(
-            FOOTPRINT.priceLevels[price+0.25].isBuyImbalance, // imbalance flag
-            FOOTPRINT.priceLevels[price+0.25].askVolume, // The value that just changed
-            FOOTPRINT.priceLevels[price].bidVolume,
+            above.isBuyImbalance, // imbalance flag
+            above.askVolume, // The value that just changed
+            current.bidVolume,
             imbalanceThreshhold );
 
-            // D) Calculate SELL imbalance at the previous price level (price - 0.25)
+            // D) Calculate SELL imbalance at the previous price level (one tick below)
             sell_imb_change += check_and_update(
-            FOOTPRINT.priceLevels[price-0.25].isSellImbalance, // imbalance flag
-            FOOTPRINT.priceLevels[price-0.25].bidVolume, // aggressor
-            FOOTPRINT.priceLevels[price].askVolume,
+            below.isSellImbalance, // imbalance flag
+            below.bidVolume, // aggressor
+            current.askVolume,
             imbalanceThreshhold );
         }
     }
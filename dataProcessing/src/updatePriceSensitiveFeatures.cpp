@@ -1,4 +1,6 @@
-#include "../dataStructure.h"
+#include <limits>
+
+#include "../engineContext.h"
 #include "../src/indicators/indicators.h"
 
 
@@ -28,63 +30,146 @@
     // pirce-IBLow diff
 
 
-void updatePriceSensitiveFeatures(Contract& contract, double currentPrice, int currentAskVolume, int currentBidVolume) {
-    auto& currentDAY = contract.weeks.back().days.back();
-    auto& prevDAY = contract.weeks.back().days[contract.weeks.back().days.size() - 2];
-    auto& currentBAR = currentDAY.bars.back();
+// copies the reference levels of the price features, called once the levels have moved:
+// after the bar change features were updated and when a new day is initialized
+void snapshotPriceReferences(EngineContext& ctx) {
+    const auto& SPEC = ctx.contract.instrument;
+    const auto& DAY = *ctx.day;
+    const auto& WEEK = *ctx.week;
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    auto& levels = ctx.levels;
+
+    levels.dayVwap = DAY.vwap;
+    levels.dayVwapUpperStdDev1 = DAY.vwapUpperStdDev1;
+    levels.dayVwapUpperStdDev2 = DAY.vwapUpperStdDev2;
+    levels.dayVwapLowerStdDev1 = DAY.vwapLowerStdDev1;
+    levels.dayVwapLowerStdDev2 = DAY.vwapLowerStdDev2;
+    levels.weekVwap = WEEK.vwap;
+    levels.weekVwapUpperStdDev1 = WEEK.vwapUpperStdDev1;
+    levels.weekVwapLowerStdDev1 = WEEK.vwapLowerStdDev1;
+    levels.bbUpper = DAY.bbUpper;
+    levels.bbLower = DAY.bbLower;
+    levels.bbMiddle = DAY.bbMiddle;
+    levels.dayVAH = SPEC.toPrice(DAY.vahTicks);
+    levels.dayVAL = SPEC.toPrice(DAY.valTicks);
+    levels.dayVahTicks = DAY.vahTicks;
+    levels.dayValTicks = DAY.valTicks;
+    levels.ibHigh = SPEC.toPrice(DAY.ibHighTicks);
+    levels.ibLow = SPEC.toPrice(DAY.ibLowTicks);
+    levels.weekHigh = SPEC.toPrice(WEEK.weekHighTicks);
+    levels.weekLow = SPEC.toPrice(WEEK.weekLowTicks);
+
+    // previous day (the last day of the previous week on a monday), there is none on the first day of the run
+    levels.hasPrevDay = ctx.prevDay != nullptr;
+    if (ctx.prevDay) {
+        const auto& prevDAY = *ctx.prevDay;
+        levels.prevDayVwap = prevDAY.vwap;
+        levels.prevDayVAH = SPEC.toPrice(prevDAY.vahTicks);
+        levels.prevDayVAL = SPEC.toPrice(prevDAY.valTicks);
+        levels.prevDayPOC = SPEC.toPrice(prevDAY.pocTicks);
+        levels.prevDayVahTicks = prevDAY.vahTicks;
+        levels.prevDayValTicks = prevDAY.valTicks;
+        levels.prevDayHigh = SPEC.toPrice(prevDAY.dayHighTicks);
+        levels.prevDayLow = SPEC.toPrice(prevDAY.dayLowTicks);
+        levels.prevDayClose = SPEC.toPrice(prevDAY.dayCloseTicks);
+    } else {
+        levels.prevDayVwap = nan;
+        levels.prevDayVAH = nan;
+        levels.prevDayVAL = nan;
+        levels.prevDayPOC = nan;
+        levels.prevDayHigh = nan;
+        levels.prevDayLow = nan;
+        levels.prevDayClose = nan;
+    }
+
+    // previous week with data, there is none in the first week of the run
+    levels.prevWeekHigh = ctx.prevWeek ? SPEC.toPrice(ctx.prevWeek->weekHighTicks) : nan;
+    levels.prevWeekLow = ctx.prevWeek ? SPEC.toPrice(ctx.prevWeek->weekLowTicks) : nan;
+}
+
+
+// the diffs of the bar's feature block at a price, against the snapshot of the reference levels
+static void fillPriceFeatures(BarFeatures& currentBAR, const PriceReferenceLevels& levels, const InstrumentSpec& SPEC, int32_t currentTicks) {
+    const double currentPrice = SPEC.toPrice(currentTicks);
 
 // price-indicator diference
     //VWAP
-    currentBAR.priceCurrentDayVwapDiff = currentPrice - currentDAY.vwap;
-    currentBAR.priceCurrentDayVwapLowerStdDev1Diff = currentPrice - currentDAY.vwapLowerStdDev1;
-    currentBAR.priceCurrentDayVwapUpperStdDev1Diff = currentPrice - currentDAY.vwapUpperStdDev1;
-    currentBAR.priceCurrentDayVwapLowerStdDev2Diff = currentPrice - currentDAY.vwapLowerStdDev2;
-    currentBAR.priceCurrentDayVwapUpperStdDev2Diff = currentPrice - currentDAY.vwapUpperStdDev2;
-    currentBAR.pricePreviousDayVwapDiff = currentPrice - prevDAY.vwap;
-    currentBAR.priceWeeklyVwapDiff = currentPrice - contract.weeks.back().vwap;
-    currentBAR.priceWeeklyVwapLowerStdDev1Diff = currentPrice - contract.weeks.back().vwapLowerStdDev1;
-    currentBAR.priceWeeklyVwapUpperStdDev1Diff = currentPrice - contract.weeks.back().vwapUpperStdDev1;
+    currentBAR.priceCurrentDayVwapDiff = currentPrice - levels.dayVwap;
+    currentBAR.priceCurrentDayVwapLowerStdDev1Diff = currentPrice - levels.dayVwapLowerStdDev1;
+    currentBAR.priceCurrentDayVwapUpperStdDev1Diff = currentPrice - levels.dayVwapUpperStdDev1;
+    currentBAR.priceCurrentDayVwapLowerStdDev2Diff = currentPrice - levels.dayVwapLowerStdDev2;
+    currentBAR.priceCurrentDayVwapUpperStdDev2Diff = currentPrice - levels.dayVwapUpperStdDev2;
+    currentBAR.priceWeeklyVwapDiff = currentPrice - levels.weekVwap;
+    currentBAR.priceWeeklyVwapLowerStdDev1Diff = currentPrice - levels.weekVwapLowerStdDev1;
+    currentBAR.priceWeeklyVwapUpperStdDev1Diff = currentPrice - levels.weekVwapUpperStdDev1;
 
     //BBands
-    currentBAR.priceBBandUpperDiff = currentPrice - currentDAY.bbUpper;
-    currentBAR.priceBBandLowerDiff = currentPrice - currentDAY.bbLower;
-    currentBAR.PriceBBandMiddleDiff = currentPrice - currentDAY.bbMiddle;
+    currentBAR.priceBBandUpperDiff = currentPrice - levels.bbUpper;
+    currentBAR.priceBBandLowerDiff = currentPrice - levels.bbLower;
+    currentBAR.PriceBBandMiddleDiff = currentPrice - levels.bbMiddle;
 
     //TPO(day)
-    currentBAR.priceCurrDayVAHDiff = currentPrice - currentDAY.vah;
-    currentBAR.priceCurrDayVALDiff = currentPrice - currentDAY.val;
-    currentBAR.pricePrevDayVAHDiff = currentPrice - prevDAY.vah;
-    currentBAR.pricePrevDayVALDiff = currentPrice - prevDAY.val;
-    currentBAR.pricePrevDayPOCDiff = currentPrice - prevDAY.poc;
-    if (currentPrice > currentDAY.val && currentPrice < currentDAY.vah){ currentBAR.isPriceInCurrentDayVA = true;}
-    else {currentBAR.isPriceInCurrentDayVA= false;}
-    if (currentPrice > prevDAY.val && currentPrice < prevDAY.vah){ currentBAR.isPriceInPrevDayVA = true;}
-    else {currentBAR.isPriceInPrevDayVA= false;}
+    currentBAR.priceCurrDayVAHDiff = currentPrice - levels.dayVAH;
+    currentBAR.priceCurrDayVALDiff = currentPrice - levels.dayVAL;
+    currentBAR.isPriceInCurrentDayVA = (currentTicks > levels.dayValTicks && currentTicks < levels.dayVahTicks);
     //TPO(week)
     // currentBAR.wee
 
     // S/R
-    currentBAR.pricePrevDayHighDiff = currentPrice - prevDAY.dayHigh;
-    currentBAR.pricePrevDayLowDiff = currentPrice - prevDAY.dayLow;
-    currentBAR.pricePrevDayCloseDiff = currentPrice - prevDAY.dayClose;
-    currentBAR.priceCurrentWeekHighDiff = currentPrice - contract.weeks.back().weekHigh;
-    currentBAR.priceCurrentWeekLowDiff = currentPrice - contract.weeks.back().weekLow;
-    currentBAR.pricePrevWeekHighDiff = currentPrice - contract.weeks[contract.weeks.size() - 2].weekHigh;
-    currentBAR.pricePrevWeekLowDiff = currentPrice - contract.weeks[contract.weeks.size() - 2].weekLow;
+    currentBAR.priceCurrentWeekHighDiff = currentPrice - levels.weekHigh;
+    currentBAR.priceCurrentWeekLowDiff = currentPrice - levels.weekLow;
+
+    // previous day and week levels are NaN when there is none, so are their diffs
+    currentBAR.pricePreviousDayVwapDiff = currentPrice - levels.prevDayVwap;
+    currentBAR.pricePrevDayVAHDiff = currentPrice - levels.prevDayVAH;
+    currentBAR.pricePrevDayVALDiff = currentPrice - levels.prevDayVAL;
+    currentBAR.pricePrevDayPOCDiff = currentPrice - levels.prevDayPOC;
+    currentBAR.isPriceInPrevDayVA = levels.hasPrevDay && (currentTicks > levels.prevDayValTicks && currentTicks < levels.prevDayVahTicks);
+    currentBAR.pricePrevDayHighDiff = currentPrice - levels.prevDayHigh;
+    currentBAR.pricePrevDayLowDiff = currentPrice - levels.prevDayLow;
+    currentBAR.pricePrevDayCloseDiff = currentPrice - levels.prevDayClose;
+    currentBAR.pricePrevWeekHighDiff = currentPrice - levels.prevWeekHigh;
+    currentBAR.pricePrevWeekLowDiff = currentPrice - levels.prevWeekLow;
+
 // to be calculated
-    currentBAR.priceIBHighDiff = currentPrice - currentDAY.ibHigh;
-    currentBAR.priceIBLowDiff = currentPrice - currentDAY.ibLow;
-    // currentBAR.priceLastSwingHighDiff = currentPrice - currentDAY.lastSwingHigh;
-    // currentBAR.priceLastSwingLowDiff = currentPrice - currentDAY.lastSwingLow;
-    // currentBAR.priceLastHVNDiff = currentPrice - currentDAY.lastHighVolumeNode;
+    currentBAR.priceIBHighDiff = currentPrice - levels.ibHigh;
+    currentBAR.priceIBLowDiff = currentPrice - levels.ibLow;
+    // currentBAR.priceLastSwingHighDiff = currentPrice - levels.lastSwingHigh;
+    // currentBAR.priceLastSwingLowDiff = currentPrice - levels.lastSwingLow;
+    // currentBAR.priceLastHVNDiff = currentPrice - levels.lastHVN;
+}
+
+
+// lazy mode: brings the current bar's feature block up to its last price change, a no-op when it already is.
+// called at bar close and at the end of the day (before the reference levels move), and by a signal that needs the features
+void materializePriceFeatures(EngineContext& ctx) {
+    if (!ctx.featuresPending) {
+        return;
+    }
+    fillPriceFeatures(*ctx.features, ctx.levels, ctx.contract.instrument, ctx.pendingTicks);
+    ctx.featuresPending = false;
+}
+
+
+void updatePriceSensitiveFeatures(EngineContext& ctx, int32_t currentTicks, int currentAskVolume, int currentBidVolume) {
+    auto& currentDAY = *ctx.day;
 
+    // the reference levels do not move inside a bar, in lazy mode only the price is remembered
+    if (ctx.lazyPriceFeatures) {
+        ctx.featuresPending = true;
+        ctx.pendingTicks = currentTicks;
+    } else {
+        fillPriceFeatures(*ctx.features, ctx.levels, ctx.contract.instrument, currentTicks);
+    }
 
 // delta divergence
-    currentDAY.priceCumDeltaDivergence5bar = calculatePriceCumDeltaDivergence(contract, 5);
-    currentDAY.priceCumDeltaDivergence10bar = calculatePriceCumDeltaDivergence(contract, 10);
+    currentDAY.priceCumDeltaDivergence5bar = calculatePriceCumDeltaDivergence(ctx, 5);
+    currentDAY.priceCumDeltaDivergence10bar = calculatePriceCumDeltaDivergence(ctx, 10);
+    currentDAY.priceCumDeltaDivergence20bar = calculatePriceCumDeltaDivergence(ctx, 20);
+    currentDAY.priceCumDeltaDivergence50bar = calculatePriceCumDeltaDivergence(ctx, 50);
 
 // interaction reversal
-    calculateInteractionReversal(contract);
+    calculateInteractionReversal(ctx);
     
     
 }
\ No newline at end of file
@@ -1,4 +1,4 @@
-#include "../dataStructure.h"
+#include "../engineContext.h"
 
 
 
@@ -19,9 +19,10 @@
     // barPOC
 
 
-void updateTickSensitiveFeatures(Contract& contract, double currentPrice, int currentAskVolume, int currentBidVolume, std::pair<int, int> imbalanceChange) {
+void updateTickSensitiveFeatures(EngineContext& ctx, int32_t currentTicks, int currentAskVolume, int currentBidVolume, std::pair<int, int> imbalanceChange) {
     // Update footprint
-    auto& BAR = contract.weeks.back().days.back().bars.back();
+    auto& DAY = *ctx.day;
+    auto& BAR = *ctx.bar;
 
     // basic
     BAR.barTotalVolume += (currentAskVolume + currentBidVolume);
@@ -34,47 +35,51 @@ void updateTickSensitiveFeatures(Contract& contract, double currentPrice, int cu
 
 
         // updating poc price and volume 
-    const auto& PRICELEVEL = BAR.footprint.priceLevels.at(currentPrice);
+    const auto& priceLevels = BAR.footprint.priceLevels;
+    const auto& PRICELEVEL = *priceLevels.find(currentTicks);
     if (PRICELEVEL.volumeAtPrice > BAR.barPOCVol){
-        BAR.barPOCPrice = currentPrice;
+        BAR.barPOCTicks = currentTicks;
         BAR.barPOCVol = PRICELEVEL.volumeAtPrice;
     
     }
 
 
 
-    // std::map is sorted, so rbegin() and begin() give us fast access to extremes.
-    auto& priceLevels = BAR.footprint.priceLevels;
+    // the ladder ends are traded levels, the second level is the next traded price inward
     if (!priceLevels.empty()) {
         // Bar High Delta (top two price levels)
-        auto r_it = priceLevels.rbegin(); // Highest price
-        int64_t high_delta = r_it->second.deltaAtPrice;
-        if (std::next(r_it)!= priceLevels.rend()) { // Check if a second level exists
-            r_it++; // Move to the second highest price
-            high_delta += r_it->second.deltaAtPrice;
+        int32_t tick = priceLevels.highTick(); // Highest price
+        int64_t high_delta = priceLevels.at(tick).deltaAtPrice;
+        while (--tick >= priceLevels.lowTick()) {
+            if (priceLevels.at(tick).isTraded) { // second highest traded price
+                high_delta += priceLevels.at(tick).deltaAtPrice;
+                break;
+            }
         }
         BAR.barHighDelta = high_delta;
 
         // Bar Low Delta (bottom two price levels)
-        auto it = priceLevels.begin(); // Lowest price
-        int64_t low_delta = it->second.deltaAtPrice;
-        if (std::next(it)!= priceLevels.end()) { // Check if a second level exists
-            it++; // Move to the second lowest price
-            low_delta += it->second.deltaAtPrice;
+        tick = priceLevels.lowTick(); // Lowest price
+        int64_t low_delta = priceLevels.at(tick).deltaAtPrice;
+        while (++tick <= priceLevels.highTick()) {
+            if (priceLevels.at(tick).isTraded) { // second lowest traded price
+                low_delta += priceLevels.at(tick).deltaAtPrice;
+                break;
+            }
         }
         BAR.barLowDelta = low_delta;
     }
     
     // updating cumulative delta
-    contract.weeks.back().days.back().cumulativeDelta += (currentAskVolume - currentBidVolume);
+    DAY.cumulativeDelta += (currentAskVolume - currentBidVolume);
 
 
     //updating delta change
-    if (contract.weeks.back().days.back().bars.size()<2) {BAR.barDeltaChange = 0;} else {
-        BAR.barDeltaChange = BAR.delta - contract.weeks.back().days.back().bars[contract.weeks.back().days.back().bars.size() - 2].delta;
+    if (DAY.bars.size()<2) {BAR.barDeltaChange = 0;} else {
+        BAR.barDeltaChange = BAR.delta - DAY.bars[DAY.bars.size() - 2].delta;
       }
         
     // updating the bars cumulative delta at bar level
-    contract.weeks.back().days.back().bars.back().cumDeltaAtBar = contract.weeks.back().days.back().cumulativeDelta;
+    BAR.cumDeltaAtBar = DAY.cumulativeDelta;
     
 }
\ No newline at end of file
@@ -1,8 +1,8 @@
-#include "../dataStructure.h"
+#include "../engineContext.h"
 
 
 
-void updateWeekChangeSensitiveFeatures(Contract& contract) {
+void updateWeekChangeSensitiveFeatures(EngineContext& ctx) {
     // Update week change sensitive features
 
     
@@ -3,24 +3,27 @@
 
 
 
-#include "../dataStructure.h"
+#include "../engineContext.h"
 #include <string>
 #include <utility>
 
 
 
-void checkForSignal(Contract& contract);
+void checkForSignal(EngineContext& ctx);
 
-std::pair<int, int> updateFootprint(Contract& contract, double imbalanceThreshhold, double currentPrice, int currentAskVolume, int currentBidVolume);
-void updateTickSensitiveFeatures(Contract& contract, double currentPrice, int currentAskVolume, int currentBidVolume, std::pair<int, int> imbalanceChange);
-void updatePriceSensitiveFeatures(Contract& contract, double currentPrice, int currentAskVolume, int currentBidVolume);
-void updateBarChangeSensitiveFeatures(Contract& contract, double currentPrice, int currentAskVolume, int currentBidVolume);
-void updateDayChangeSensitiveFeatures(Contract& contract);
-void updateWeekChangeSensitiveFeatures(Contract& contract);
+// the per tick and per bar updates work on the handles of the engine context, prices are passed in ticks of contract.instrument
+std::pair<int, int> updateFootprint(EngineContext& ctx, double imbalanceThreshhold, int32_t currentTicks, int currentAskVolume, int currentBidVolume);
+void updateTickSensitiveFeatures(EngineContext& ctx, int32_t currentTicks, int currentAskVolume, int currentBidVolume, std::pair<int, int> imbalanceChange);
+void updatePriceSensitiveFeatures(EngineContext& ctx, int32_t currentTicks, int currentAskVolume, int currentBidVolume);
+void snapshotPriceReferences(EngineContext& ctx);
+void materializePriceFeatures(EngineContext& ctx);
+void updateBarChangeSensitiveFeatures(EngineContext& ctx, int32_t currentTicks, int currentAskVolume, int currentBidVolume);
+void updateDayChangeSensitiveFeatures(EngineContext& ctx);
+void updateWeekChangeSensitiveFeatures(EngineContext& ctx);
 
-void initializeNewBar(Contract& contract, std::string datetime, double currentPrice, int currentAskVolume, int currentBidVolume);
-void finalizeProcessingDay(Contract& contract);
-void initializeWeek(Contract& contract);
+void initializeNewBar(EngineContext& ctx, int64_t datetime, int32_t currentTicks, int currentAskVolume, int currentBidVolume);
+void finalizeProcessingDay(EngineContext& ctx);
+void initializeWeek(EngineContext& ctx);
 void finalizeContract(Contract& contract);
 
 
@@ -0,0 +1,146 @@
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <string>
+#include <algorithm>
+
+// the header only accumulators the indicators are built on
+#include "../rollingWindow.h"
+
+static int failures = 0;
+
+// A helper function to check floating-point equality
+void check(double value, double expected, const std::string& testName) {
+    const double epsilon = 1e-7;
+    if (std::abs(value - expected) > epsilon * std::max(1.0, std::abs(expected))) {
+        std::cerr << "TEST FAILED [" << testName << "]: Expected " << expected << ", but got " << value << std::endl;
+        ++failures;
+    }
+}
+
+// deterministic integer series with runs, jumps and a flat stretch
+std::vector<double> series() {
+    std::vector<double> values;
+    for (int i = 0; i < 400; ++i) {
+        if (i >= 150 && i < 170) {
+            values.push_back(42.0);
+        } else {
+            values.push_back(static_cast<double>(((i * 7919) % 211) - 105) + (i / 50) * 1000.0);
+        }
+    }
+    return values;
+}
+
+int main() {
+    std::cout << "Running Rolling Window Test..." << std::endl;
+    const std::vector<double> values = series();
+
+    // --- Test 1: mean and population variance against a two pass over the window ---
+    {
+        RollingMeanVariance<7> window;
+        for (size_t i = 0; i < values.size(); ++i) {
+            window.push(values[i]);
+            const size_t n = std::min<size_t>(i + 1, 7);
+            double mean = 0.0;
+            for (size_t j = i + 1 - n; j <= i; ++j) mean += values[j];
+            mean /= n;
+            double variance = 0.0;
+            for (size_t j = i + 1 - n; j <= i; ++j) variance += (values[j] - mean) * (values[j] - mean);
+            variance /= n;
+            check(window.mean(), mean, "mean at " + std::to_string(i));
+            check(window.variance() + 1.0, variance + 1.0, "variance at " + std::to_string(i));
+        }
+        std::cout << "Test (mean/variance): Passed." << std::endl;
+    }
+
+    // --- Test 2: regression slope against the textbook sums over the window ---
+    {
+        RollingLinearRegression<5> window;
+        for (size_t i = 0; i < values.size(); ++i) {
+            window.push(values[i]);
+            const size_t n = std::min<size_t>(i + 1, 5);
+            double sumX = 0.0, sumY = 0.0, sumXY = 0.0, sumXX = 0.0;
+            for (size_t x = 0; x < n; ++x) {
+                const double y = values[i + 1 - n + x];
+                sumX += x;
+                sumY += y;
+                sumXY += x * y;
+                sumXX += static_cast<double>(x * x);
+            }
+            const double slope = n < 2 ? 0.0 : (n * sumXY - sumX * sumY) / (n * sumXX - sumX * sumX);
+            check(window.slope(), slope, "slope at " + std::to_string(i));
+        }
+        std::cout << "Test (regression): Passed." << std::endl;
+    }
+
+    // --- Test 3: runtime sized window, slope with a live point after the window ---
+    {
+        RollingLinearRegression<RUNTIME_WINDOW> window(9);
+        for (size_t i = 0; i + 1 < values.size(); ++i) {
+            window.push(values[i]);
+            const double live = values[i + 1];
+            const size_t n = std::min<size_t>(i + 1, 9) + 1;
+            double sumX = 0.0, sumY = 0.0, sumXY = 0.0, sumXX = 0.0;
+            for (size_t x = 0; x < n; ++x) {
+                const double y = x + 1 < n ? values[i + 2 - n + x] : live;
+                sumX += x;
+                sumY += y;
+                sumXY += x * y;
+                sumXX += static_cast<double>(x * x);
+            }
+            const double slope = (n * sumXY - sumX * sumY) / (n * sumXX - sumX * sumX);
+            check(window.slopeWith(live), slope, "slope with live at " + std::to_string(i));
+        }
+        std::cout << "Test (runtime regression): Passed." << std::endl;
+    }
+
+    // --- Test 4: min and max against a scan of the window, including the flat stretch ---
+    {
+        RollingMinMax<9> window;
+        for (size_t i = 0; i < values.size(); ++i) {
+            window.push(values[i]);
+            const size_t n = std::min<size_t>(i + 1, 9);
+            const double lowest = *std::min_element(values.begin() + (i + 1 - n), values.begin() + (i + 1));
+            const double highest = *std::max_element(values.begin() + (i + 1 - n), values.begin() + (i + 1));
+            check(window.min(), lowest, "min at " + std::to_string(i));
+            check(window.max(), highest, "max at " + std::to_string(i));
+            check(static_cast<double>(window.count()), static_cast<double>(n), "count at " + std::to_string(i));
+        }
+        std::cout << "Test (min/max): Passed." << std::endl;
+    }
+
+    // --- Test 5: Wilder average seeds with the plain mean, then smooths ---
+    {
+        WilderAverage<3> wilder;
+        wilder.push(1.0);
+        check(wilder.value(), 1.0, "wilder 1");
+        wilder.push(3.0);
+        check(wilder.value(), 2.0, "wilder 2");
+        wilder.push(5.0);
+        check(wilder.value(), 3.0, "wilder seed");
+        wilder.push(9.0);
+        check(wilder.value(), (3.0 * 2 + 9.0) / 3, "wilder smoothed");
+        std::cout << "Test (Wilder): Passed." << std::endl;
+    }
+
+    // --- Test 6: smoothed average, (avg * (N - 1) + x) / N, re-seeded while it is 0 ---
+    {
+        SmoothedAverage<10> smoothed;
+        smoothed.push(0.0);
+        check(smoothed.value(), 0.0, "smoothed zero");
+        smoothed.push(10.0);
+        check(smoothed.value(), 10.0, "smoothed seed after zero");
+        smoothed.push(20.0);
+        check(smoothed.value(), 11.0, "smoothed 2");
+        smoothed.push(0.0);
+        check(smoothed.value(), 9.9, "smoothed 3");
+        std::cout << "Test (smoothed average): Passed." << std::endl;
+    }
+
+    if (failures > 0) {
+        std::cerr << failures << " checks failed" << std::endl;
+        return 1;
+    }
+    std::cout << "All Rolling Window tests passed successfully!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,154 @@
+#include <iostream>
+#include <vector>
+#include <map>
+#include <random>
+#include <string>
+
+// the real store and profile, the test builds sessions the way updateFootprint feeds them
+#include "../sessionProfiles.h"
+
+static int failures = 0;
+
+// A helper function to check integer equality
+void check(int64_t value, int64_t expected, const std::string& testName) {
+    if (value != expected) {
+        std::cerr << "TEST FAILED [" << testName << "]: Expected " << expected << ", but got " << value << std::endl;
+        ++failures;
+    }
+}
+
+// one session as the volume per tick it was fed with
+using Session = std::map<int32_t, int64_t>;
+
+VolumeProfile toProfile(const Session& session) {
+    VolumeProfile profile;
+    for (const auto& [tick, volume] : session) {
+        profile.add(tick, volume, 0);
+    }
+    return profile;
+}
+
+// brute force composite of sessions [first, last) straight from the per tick volumes
+CompositeProfile bruteComposite(const std::vector<Session>& sessions, size_t first, size_t last, double share) {
+    CompositeProfile result;
+    Session merged;
+    for (size_t s = first; s < last && s < sessions.size(); ++s) {
+        for (const auto& [tick, volume] : sessions[s]) {
+            merged[tick] += volume;
+        }
+    }
+    int64_t total = 0;
+    int64_t pocVolume = 0;
+    for (const auto& [tick, volume] : merged) {
+        total += volume;
+        if (volume > pocVolume) {   // the lowest price wins ties
+            pocVolume = volume;
+            result.pocTicks = tick;
+        }
+    }
+    if (total == 0) {
+        return CompositeProfile();
+    }
+    int64_t hvnVolume = 0;
+    for (const auto& [tick, volume] : merged) {
+        if (tick != result.pocTicks && volume > hvnVolume) {
+            hvnVolume = volume;
+            result.hvnTicks = tick;
+        }
+    }
+
+    // value area by volume quantiles, the first prices whose cumulative volume passes each tail
+    const double tail = total * (1.0 - share) / 2.0;
+    int64_t cumulative = 0;
+    bool valFound = false;
+    bool vahFound = false;
+    for (int32_t tick = merged.begin()->first; tick <= merged.rbegin()->first; ++tick) {
+        auto it = merged.find(tick);
+        cumulative += it != merged.end() ? it->second : 0;
+        if (!valFound && static_cast<double>(cumulative) > tail) {
+            result.valTicks = tick;
+            valFound = true;
+        }
+        if (!vahFound && static_cast<double>(cumulative) >= total - tail) {
+            result.vahTicks = tick;
+            vahFound = true;
+        }
+    }
+    result.totalVolume = total;
+    return result;
+}
+
+void checkComposite(const SessionProfileStore& store, const std::vector<Session>& sessions,
+                    size_t first, size_t last, const std::string& testName) {
+    const CompositeProfile got = store.composite(first, last);
+    const CompositeProfile expected = bruteComposite(sessions, first, last, VALUE_AREA_SHARE);
+    check(got.totalVolume, expected.totalVolume, testName + " totalVolume");
+    check(got.pocTicks, expected.pocTicks, testName + " POC");
+    check(got.hvnTicks, expected.hvnTicks, testName + " HVN");
+    check(got.valTicks, expected.valTicks, testName + " VAL");
+    check(got.vahTicks, expected.vahTicks, testName + " VAH");
+}
+
+int main() {
+    std::cout << "Running Session Profile Store Test..." << std::endl;
+
+    // --- Test 1: hand made sessions, ties and an empty session ---
+    {
+        std::vector<Session> sessions = {
+            {{100, 5}, {101, 5}, {102, 1}},
+            {},
+            {{99, 2}, {101, 3}, {103, 7}},
+        };
+        SessionProfileStore store;
+        for (const auto& session : sessions) {
+            store.addSession(toProfile(session));
+        }
+        check(store.sessionCount(), 3, "session count");
+        checkComposite(store, sessions, 0, 1, "first session");
+        checkComposite(store, sessions, 1, 2, "empty session");
+        checkComposite(store, sessions, 0, 3, "all sessions");
+        checkComposite(store, sessions, 2, 3, "last session");
+        check(store.composite(0, 3).pocTicks, 101, "all sessions POC by hand");
+        check(store.lastSessions(2).pocTicks, 103, "last two sessions POC by hand");
+        std::cout << "Test (hand made sessions): Passed." << std::endl;
+    }
+
+    // --- Test 2: random sessions drifting over different price ranges ---
+    // the jumps move sessions far outside the ladder's headroom, so the rows are re-based several times
+    {
+        std::mt19937 rng(20240212);
+        std::vector<Session> sessions;
+        SessionProfileStore store;
+        int32_t center = 20000;
+        for (int s = 0; s < 40; ++s) {
+            center += static_cast<int32_t>(rng() % 61) - 30;
+            if (s % 9 == 4) {
+                center += (s % 2 ? 1 : -1) * 700;
+            }
+            const int32_t width = 5 + static_cast<int32_t>(rng() % 80);
+            Session session;
+            for (int t = 0; t < 300; ++t) {
+                const int32_t tick = center - width / 2 + static_cast<int32_t>(rng() % width);
+                session[tick] += 1 + static_cast<int64_t>(rng() % 20);
+            }
+            sessions.push_back(session);
+            store.addSession(toProfile(session));
+
+            for (size_t n : {1, 3, 5, 20}) {
+                const size_t last = sessions.size();
+                const size_t first = last > n ? last - n : 0;
+                checkComposite(store, sessions, first, last, "random last " + std::to_string(n) + " at " + std::to_string(s));
+            }
+        }
+        checkComposite(store, sessions, 0, sessions.size(), "random contract to date");
+        checkComposite(store, sessions, 3, 17, "random middle run");
+        std::cout << "Test (random sessions): Passed." << std::endl;
+    }
+
+    if (failures > 0) {
+        std::cerr << failures << " checks failed" << std::endl;
+        return 1;
+    }
+    std::cout << "All Session Profile Store tests passed successfully!" << std::endl;
+    return 0;
+}
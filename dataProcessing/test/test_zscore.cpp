@@ -1,22 +1,21 @@
 #include <iostream>
 #include <vector>
-#include <cassert>
 #include <cmath>
+#include <string>
 
 // --- The REAL Data Structure ---
-// REMOVE all mock structs and include the actual header file.
-// This ensures the test and the production code use the exact same object layout.
-#include "../dataStructure.h"
+// The test and the production code use the exact same object layout and engine context.
+#include "../engineContext.h"
+#include "../src/indicators/indicators.h"
 
-// Forward declare the function we are testing
-void calculateDeltaZscore(Contract& contract);
+static int failures = 0;
 
 // A helper function to check floating-point equality
 void check(double value, double expected, const std::string& testName) {
     const double epsilon = 1e-5;
     if (std::abs(value - expected) > epsilon) {
         std::cerr << "TEST FAILED [" << testName << "]: Expected " << expected << ", but got " << value << std::endl;
-        assert(false);
+        ++failures;
     }
 }
 
@@ -26,11 +25,16 @@ void setupContract(Contract& contract) {
     contract.weeks.back().days.push_back(Day());
 }
 
-// Helper to create a bar and set its delta explicitly
-Bar createBarWithDelta(int deltaValue) {
-    Bar bar; // This now creates the REAL, complex Bar object
+// Closes a bar with the given delta the way updateBarChangeSensitiveFeatures does:
+// the bar is appended to the day's columns, then the indicator runs
+void closeBarWithDelta(EngineContext& ctx, int deltaValue) {
+    Bar bar;
     bar.delta = deltaValue;
-    return bar;
+    ctx.day->bars.push_back(bar);
+    ctx.day->barFeatures.emplace_back();
+    ctx.refreshBar();
+    ctx.day->closedBars.append(bar);
+    calculateDeltaZscore(ctx);
 }
 
 int main() {
@@ -40,82 +44,106 @@ int main() {
     {
         Contract contract;
         setupContract(contract);
-        auto& day = contract.weeks.back().days.back();
-        day.bars.push_back(createBarWithDelta(10));
-        calculateDeltaZscore(contract);
+        EngineContext ctx(contract);
+        closeBarWithDelta(ctx, 10);
 
-        check(day.deltaSum, 10.0, "n=1 Sum");
-        check(day.deltaSumOfSquares, 100.0, "n=1 SumOfSquares");
-        check(day.deltaZscore20bars, 10.0, "n=1 Z-score"); // Per code logic
+        check(ctx.day->deltaWindow.mean(), 10.0, "n=1 Mean");
+        check(ctx.day->deltaWindow.variance(), 0.0, "n=1 Variance");
+        check(ctx.day->deltaZscore11bars, 10.0, "n=1 Z-score"); // Per code logic
         std::cout << "Test (n=1): Passed." << std::endl;
     }
 
-    // --- Test 2: n = 2 (Seeding) ---
+    // --- Test 2: n = 2 (Warm-up) ---
     {
         Contract contract;
         setupContract(contract);
-        auto& day = contract.weeks.back().days.back();
-        day.bars.push_back(createBarWithDelta(10));
-        calculateDeltaZscore(contract); // n=1 call
-        day.bars.push_back(createBarWithDelta(12));
-        calculateDeltaZscore(contract); // n=2 call
+        EngineContext ctx(contract);
+        closeBarWithDelta(ctx, 10);
+        closeBarWithDelta(ctx, 12);
 
         // Manual Calc: mean=(10+12)/2=11, var=(100+144)/2 - 11^2 = 1, stdDev=1
         // Z = (12 - 11) / 1 = 1
-        check(day.deltaZscore20bars, 1.0, "n=2 Z-score");
-        std::cout << "Test (n=2 Seeding): Passed." << std::endl;
+        check(ctx.day->deltaZscore11bars, 1.0, "n=2 Z-score");
+        std::cout << "Test (n=2 Warm-up): Passed." << std::endl;
     }
 
-    // --- Test 3: n = 20 (End of Seeding) ---
+    // --- Test 3: n = 11 (Window just full) ---
     {
         Contract contract;
         setupContract(contract);
-        auto& day = contract.weeks.back().days.back();
-        for (int i = 1; i <= 20; ++i) {
-            day.bars.push_back(createBarWithDelta(i));
-            calculateDeltaZscore(contract);
+        EngineContext ctx(contract);
+        for (int i = 1; i <= 11; ++i) {
+            closeBarWithDelta(ctx, i);
+        }
+        // Manual Calc: deltas 1..11. mean=6, var=10, stdDev=3.16228
+        // Z = (11 - 6) / 3.16228 = 1.58114
+        check(ctx.day->deltaZscore11bars, 1.58114, "n=11 Z-score");
+        check(ctx.day->deltaWindow.mean(), 6.0, "n=11 Mean");
+        check(ctx.day->deltaWindow.variance(), 10.0, "n=11 Variance");
+        std::cout << "Test (n=11 Window full): Passed." << std::endl;
+    }
+
+    // --- Test 4: n = 12 (First Rolling Update) ---
+    {
+        Contract contract;
+        setupContract(contract);
+        EngineContext ctx(contract);
+        for (int i = 1; i <= 12; ++i) {
+            closeBarWithDelta(ctx, i);
         }
-        // Manual Calc: deltas 1..20. mean=10.5, var=33.25, stdDev=5.76628
-        // Z = (20 - 10.5) / 5.76628 = 1.6475
-        check(day.deltaZscore20bars, 1.64751, "n=20 Z-score");
-        check(day.deltaSum, 210.0, "n=20 Sum");
-        check(day.deltaSumOfSquares, 2870.0, "n=20 SumOfSquares");
-        std::cout << "Test (n=20 Seeding): Passed." << std::endl;
+        // Manual Calc: window is 2..12. old=1 leaves, new=12 comes in.
+        // mean=7, var=10, stdDev=3.16228
+        // Z = (12 - 7) / 3.16228 = 1.58114
+        check(ctx.day->deltaZscore11bars, 1.58114, "n=12 Z-score");
+        check(ctx.day->deltaWindow.mean(), 7.0, "n=12 Mean");
+        check(ctx.day->deltaWindow.variance(), 10.0, "n=12 Variance");
+        std::cout << "Test (n=12 Rolling): Passed." << std::endl;
     }
 
-    // --- Test 4: n = 21 (First Rolling Update) ---
+    // --- Test 5: long run against a two pass z-score of the last 11 deltas ---
     {
         Contract contract;
         setupContract(contract);
-        auto& day = contract.weeks.back().days.back();
-        for (int i = 1; i <= 21; ++i) {
-            day.bars.push_back(createBarWithDelta(i));
-            calculateDeltaZscore(contract);
+        EngineContext ctx(contract);
+        std::vector<int> deltas;
+        for (int i = 0; i < 500; ++i) {
+            const int delta = ((i * 7919) % 401) - 200;
+            deltas.push_back(delta);
+            closeBarWithDelta(ctx, delta);
+
+            const size_t n = std::min<size_t>(deltas.size(), 11);
+            if (n < 2) {
+                continue;
+            }
+            double mean = 0.0;
+            for (size_t j = deltas.size() - n; j < deltas.size(); ++j) mean += deltas[j];
+            mean /= n;
+            double variance = 0.0;
+            for (size_t j = deltas.size() - n; j < deltas.size(); ++j) variance += (deltas[j] - mean) * (deltas[j] - mean);
+            variance /= n;
+            const double expected = variance > 0 ? (delta - mean) / std::sqrt(variance) : 0.0;
+            check(ctx.day->deltaZscore11bars, expected, "long run Z-score at " + std::to_string(i));
         }
-        // Manual Calc: window is 2..21. old=1, new=21.
-        // newSum = 210-1+21=230, newSumSq=2870-1+441=3310
-        // mean=230/20=11.5, var=(3310/20)-11.5^2=33.25, stdDev=5.76628
-        // Z = (21 - 11.5) / 5.76628 = 1.6475
-        check(day.deltaZscore20bars, 1.64751, "n=21 Z-score");
-        check(day.deltaSum, 230.0, "n=21 Sum");
-        check(day.deltaSumOfSquares, 3310.0, "n=21 SumOfSquares");
-        std::cout << "Test (n=21 Rolling): Passed." << std::endl;
+        std::cout << "Test (long run): Passed." << std::endl;
     }
 
-    // --- Test 5: Zero Standard Deviation ---
+    // --- Test 6: Zero Standard Deviation ---
     {
         Contract contract;
         setupContract(contract);
-        auto& day = contract.weeks.back().days.back();
+        EngineContext ctx(contract);
         for (int i = 1; i <= 20; ++i) {
-            day.bars.push_back(createBarWithDelta(5)); // All deltas are the same
-            calculateDeltaZscore(contract);
+            closeBarWithDelta(ctx, 5); // All deltas are the same
         }
         // StdDev is 0, so Z-score should be 0
-        check(day.deltaZscore20bars, 0.0, "Zero StdDev Z-score");
+        check(ctx.day->deltaZscore11bars, 0.0, "Zero StdDev Z-score");
         std::cout << "Test (Zero StdDev): Passed." << std::endl;
     }
 
+    if (failures > 0) {
+        std::cerr << failures << " checks failed" << std::endl;
+        return 1;
+    }
     std::cout << "All Delta Z-score tests passed successfully!" << std::endl;
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,104 @@
+#include <cstdio>
+#include <string>
+#include "tickTime.h"
+
+static const int64_t NS_PER_SECOND = 1000000000LL;
+static const int64_t NS_PER_DAY = 86400LL * NS_PER_SECOND;
+
+// days since 1970-01-01 of a proleptic gregorian date (H. Hinnant's days_from_civil)
+static int64_t daysFromCivil(int y, int m, int d) {
+    y -= m <= 2;
+    const int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const int64_t yoe = y - era * 400;
+    const int64_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+// inverse of daysFromCivil
+static Date civilFromDays(int64_t z) {
+    z += 719468;
+    const int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    const int64_t doe = z - era * 146097;
+    const int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const int64_t mp = (5 * doy + 2) / 153;
+    const int d = static_cast<int>(doy - (153 * mp + 2) / 5 + 1);
+    const int m = static_cast<int>(mp < 10 ? mp + 3 : mp - 9);
+    const int y = static_cast<int>(yoe + era * 400 + (m <= 2));
+    return Date{y, m, d};
+}
+
+
+int64_t parseDateTimeNs(const char* text) {
+    const char* p = text;
+    auto number = [&p](int len) {
+        int value = 0;
+        for (int i = 0; i < len && *p >= '0' && *p <= '9'; ++i, ++p) {
+            value = value * 10 + (*p - '0');
+        }
+        return value;
+    };
+    auto skip = [&p]() { if (*p != '\0') ++p; };
+
+    int y = number(4); skip();
+    int m = number(2); skip();
+    int d = number(2);
+    int hh = 0, mm = 0, ss = 0;
+    int64_t fraction = 0;
+    if (*p == ' ' || *p == 'T') {
+        skip();
+        hh = number(2); skip();
+        mm = number(2); skip();
+        ss = number(2);
+        if (*p == '.') {
+            skip();
+            int64_t scale = NS_PER_SECOND;
+            while (*p >= '0' && *p <= '9') {
+                scale /= 10;
+                fraction += (*p - '0') * scale;
+                ++p;
+            }
+        }
+    }
+    return daysFromCivil(y, m, d) * NS_PER_DAY + ((hh * 60LL + mm) * 60LL + ss) * NS_PER_SECOND + fraction;
+}
+
+
+std::string formatDateTimeNs(int64_t ns) {
+    int64_t days = ns / NS_PER_DAY;
+    int64_t rest = ns % NS_PER_DAY;
+    if (rest < 0) {
+        rest += NS_PER_DAY;
+        --days;
+    }
+    Date date = civilFromDays(days);
+    int64_t seconds = rest / NS_PER_SECOND;
+    int64_t fraction = rest % NS_PER_SECOND;
+
+    char buffer[40];
+    int len = snprintf(buffer, sizeof(buffer), "%04d-%02d-%02d %02d:%02d:%02d", date.y, date.m, date.d,
+                       static_cast<int>(seconds / 3600), static_cast<int>(seconds / 60 % 60), static_cast<int>(seconds % 60));
+    if (fraction != 0) {
+        if (fraction % 1000 == 0) {
+            snprintf(buffer + len, sizeof(buffer) - len, ".%06lld", static_cast<long long>(fraction / 1000));
+        } else {
+            snprintf(buffer + len, sizeof(buffer) - len, ".%09lld", static_cast<long long>(fraction));
+        }
+    }
+    return std::string(buffer);
+}
+
+
+Date dateFromNs(int64_t ns) {
+    int64_t days = ns / NS_PER_DAY;
+    if (ns % NS_PER_DAY < 0) {
+        --days;
+    }
+    return civilFromDays(days);
+}
+
+
+int64_t dateToNs(Date date) {
+    return daysFromCivil(date.y, date.m, date.d) * NS_PER_DAY;
+}
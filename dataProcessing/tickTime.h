@@ -0,0 +1,23 @@
+#ifndef TICKTIME_H
+#define TICKTIME_H
+
+#include <cstdint>
+#include <string>
+#include "dataStructure.h"
+
+// tick timestamps are carried through the engine as nanoseconds since 1970-01-01 of the
+// (timezone naive) DateTime column, strings are only produced again when exporting
+
+// parses "YYYY-MM-DD HH:MM:SS[.fffffffff]" (a 'T' separator or a bare date are accepted too)
+int64_t parseDateTimeNs(const char* text);
+
+// formats back to "YYYY-MM-DD HH:MM:SS" with the fraction only when it is non zero
+std::string formatDateTimeNs(int64_t ns);
+
+// calendar day of a timestamp
+Date dateFromNs(int64_t ns);
+
+// timestamp of 00:00:00 of the given day
+int64_t dateToNs(Date date);
+
+#endif // TICKTIME_H
@@ -0,0 +1,145 @@
+#ifndef VOLUME_PROFILE_H
+#define VOLUME_PROFILE_H
+
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <limits>
+#include <algorithm>
+
+
+// share of the session volume inside the value area
+constexpr double VALUE_AREA_SHARE = 0.70;
+
+
+// volume and delta histogram of a whole session (day or week) on a tick ladder, fed tick by tick.
+// the POC and the high volume node (largest level besides the POC) are kept up to date on every add,
+// ties go to the lower price like the old map scan did. only volume is ever added, which is what
+// makes the O(1) update exact.
+// slots between traded prices stay in the ladder with isTraded false and are skipped like missing levels
+class VolumeProfile {
+public:
+    void add(int32_t tick, int64_t volume, int64_t delta) {
+        Level& level = slot(tick);
+        level.isTraded = true;
+        level.volume += volume;
+        level.delta += delta;
+        total += volume;
+
+        const int64_t v = level.volume;
+        if (v > 0 && tick == poc && pocVol > 0) {
+            pocVol = v;
+        } else if (v > pocVol || (v == pocVol && v > 0 && tick < poc)) {
+            // the old POC beats every other level, so it is the new high volume node
+            hvn = poc;
+            hvnVol = pocVol;
+            poc = tick;
+            pocVol = v;
+        } else if (tick == hvn && hvnVol > 0) {
+            hvnVol = v;
+        } else if (v > hvnVol || (v == hvnVol && v > 0 && tick < hvn)) {
+            hvn = tick;
+            hvnVol = v;
+        }
+    }
+
+    bool empty() const { return levels.empty(); }
+    int64_t totalVolume() const { return total; }
+    int32_t pocTick() const { return poc; }          // 0 while no volume was added
+    int64_t pocVolume() const { return pocVol; }
+    int32_t hvnTick() const { return hvn; }          // 0 while fewer than two levels have volume
+
+    int64_t volumeAt(int32_t tick) const { return inside(tick) ? levels[tick - firstTick].volume : 0; }
+    int64_t deltaAt(int32_t tick) const { return inside(tick) ? levels[tick - firstTick].delta : 0; }
+
+    // calls f(tick, volume) for every traded level from the lowest price up
+    template <typename F>
+    void forEachLevel(F&& f) const {
+        for (size_t i = 0; i < levels.size(); ++i) {
+            if (levels[i].isTraded) {
+                f(firstTick + static_cast<int32_t>(i), levels[i].volume);
+            }
+        }
+    }
+
+    // {val, vah} holding `share` of the volume, grown from the POC one traded level at a time
+    // towards the side with more volume (below on ties). costs the width of the value area, not the session
+    std::pair<int32_t, int32_t> valueArea(double share) const {
+        const int64_t target = static_cast<int64_t>(total * share);
+        int64_t current = pocVol;
+        // a profile of zero volume prints only, the old scan anchored at its lowest level
+        int32_t lo = pocVol > 0 ? poc : nextTraded(firstTick - 1);
+        int32_t hi = lo;
+
+        while (current < target) {
+            const int32_t above = nextTraded(hi);
+            const int32_t below = prevTraded(lo);
+            const int64_t volumeAbove = above != NONE ? levels[above - firstTick].volume : 0;
+            const int64_t volumeBelow = below != NONE ? levels[below - firstTick].volume : 0;
+            if (volumeAbove == 0 && volumeBelow == 0) {
+                break;
+            }
+            if (volumeAbove > volumeBelow) {
+                current += volumeAbove;
+                hi = above;
+            } else {
+                current += volumeBelow;
+                lo = below;
+            }
+        }
+        return {lo, hi};
+    }
+
+private:
+    struct Level {
+        int64_t volume = 0;
+        int64_t delta = 0;
+        bool isTraded = false;
+    };
+
+    static constexpr int32_t NONE = std::numeric_limits<int32_t>::min();
+
+    int32_t highTick() const { return firstTick + static_cast<int32_t>(levels.size()) - 1; }
+    bool inside(int32_t tick) const { return !levels.empty() && tick >= firstTick && tick <= highTick(); }
+
+    int32_t nextTraded(int32_t tick) const {
+        for (int32_t t = tick + 1; t <= highTick(); ++t) {
+            if (levels[t - firstTick].isTraded) return t;
+        }
+        return NONE;
+    }
+
+    int32_t prevTraded(int32_t tick) const {
+        for (int32_t t = tick - 1; t >= firstTick; --t) {
+            if (levels[t - firstTick].isTraded) return t;
+        }
+        return NONE;
+    }
+
+    // a session keeps drifting into new prices, so the ladder grows with headroom on the low side
+    // instead of shifting every level once per new low
+    Level& slot(int32_t tick) {
+        if (levels.empty()) {
+            levels.reserve(256);
+            levels.emplace_back();
+            firstTick = tick;
+        } else if (tick < firstTick) {
+            const int32_t grow = std::max<int32_t>(firstTick - tick, static_cast<int32_t>(levels.size() / 2));
+            levels.insert(levels.begin(), grow, Level());
+            firstTick -= grow;
+        } else if (tick > highTick()) {
+            levels.resize(tick - firstTick + 1);
+        }
+        return levels[tick - firstTick];
+    }
+
+    std::vector<Level> levels;
+    int32_t firstTick = 0;
+    int64_t total = 0;
+    int32_t poc = 0;
+    int64_t pocVol = 0;
+    int32_t hvn = 0;
+    int64_t hvnVol = 0;
+};
+
+#endif // VOLUME_PROFILE_H